@@ -0,0 +1,142 @@
+#include "heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*pide un bloque nuevo al sistema y lo pone al frente de la lista de la arena
+E: arena, cantidad minima de bytes que debe caber en el bloque
+S: puntero al bloque nuevo, NULL si falla
+R: que la arena exista
+*/
+static struct bloque_arena* agregar_bloque(struct arena* arena, size_t minimo) {
+    size_t capacidad = arena->tamano_bloque;
+    if (capacidad < minimo) {
+        capacidad = minimo; //cadenas mas grandes que un bloque reciben su propio bloque
+    }
+
+    struct bloque_arena* bloque = malloc(sizeof(struct bloque_arena) + capacidad);
+    if (bloque == NULL) {
+        fprintf(stderr, "Error: no se pudo asignar un bloque de %zu bytes para la arena.\n", capacidad);
+        return NULL;
+    }
+
+    bloque->usado = 0;
+    bloque->capacidad = capacidad;
+    bloque->siguiente = arena->bloques;
+    arena->bloques = bloque;
+    return bloque;
+}
+
+/*deja la arena lista para usarse, sin bloques todavía
+E: arena, tamaño de cada bloque (0 para usar el de por defecto)
+S: void
+R: que la arena no sea NULL
+*/
+void iniciar_arena(struct arena* arena, size_t tamano_bloque) {
+    if (arena == NULL) return;
+    arena->bloques = NULL;
+    arena->tamano_bloque = (tamano_bloque > 0) ? tamano_bloque : TAMANO_BLOQUE_ARENA;
+}
+
+/*reserva memoria dentro de la arena moviendo un puntero (bump pointer), alineada a 8 bytes
+E: arena, cantidad de bytes
+S: puntero a la memoria reservada, NULL si falla
+R: que la arena haya sido iniciada
+*/
+void* arena_reservar(struct arena* arena, size_t bytes) {
+    if (arena == NULL) return NULL;
+
+    struct bloque_arena* bloque = arena->bloques;
+    size_t inicio = 0;
+    if (bloque != NULL) {
+        inicio = (bloque->usado + 7) & ~(size_t) 7;
+    }
+
+    if (bloque == NULL || inicio + bytes > bloque->capacidad) {
+        bloque = agregar_bloque(arena, bytes);
+        if (bloque == NULL) return NULL;
+        inicio = 0;
+    }
+
+    bloque->usado = inicio + bytes;
+    return bloque->datos + inicio;
+}
+
+/*copia una cadena (que no necesita terminar en '\0') dentro de la arena y le agrega el '\0'
+E: arena, inicio de la cadena y su largo en bytes
+S: puntero a la copia dentro de la arena, NULL si falla
+R: que la arena haya sido iniciada, que inicio no sea NULL
+*/
+char* arena_copiar(struct arena* arena, const char* inicio, size_t largo) {
+    if (arena == NULL || inicio == NULL) return NULL;
+
+    struct bloque_arena* bloque = arena->bloques;
+    //las cadenas no necesitan alineacion, asi quedan pegadas una tras otra
+    if (bloque == NULL || bloque->usado + largo + 1 > bloque->capacidad) {
+        bloque = agregar_bloque(arena, largo + 1);
+        if (bloque == NULL) return NULL;
+    }
+
+    char* copia = bloque->datos + bloque->usado;
+    memcpy(copia, inicio, largo);
+    copia[largo] = '\0';
+    bloque->usado += largo + 1;
+    return copia;
+}
+
+/*pasa todos los bloques de origen al final de destino, sin copiar nada; sirve para juntar
+las arenas que llenaron varios hilos. destino sigue escribiendo en su bloque actual
+E: arena destino, arena origen (queda vacia)
+S: void
+R: que las dos arenas hayan sido iniciadas
+*/
+void arena_absorber(struct arena* destino, struct arena* origen) {
+    if (destino == NULL || origen == NULL || origen->bloques == NULL) return;
+
+    if (destino->bloques == NULL) {
+        destino->bloques = origen->bloques;
+    } else {
+        struct bloque_arena* ultimo = destino->bloques;
+        while (ultimo->siguiente != NULL) {
+            ultimo = ultimo->siguiente;
+        }
+        ultimo->siguiente = origen->bloques;
+    }
+    origen->bloques = NULL;
+}
+
+/*deja la arena vacia para volver a usarla: se queda con el bloque actual (sin liberarlo ni pedir
+otro) y libera los demas, asi una arena que se llena y se vacia muchas veces no llama a malloc cada vez
+E: arena
+S: void
+R: que la arena haya sido iniciada
+*/
+void vaciar_arena(struct arena* arena) {
+    if (arena == NULL || arena->bloques == NULL) return;
+
+    struct bloque_arena* bloque = arena->bloques->siguiente;
+    while (bloque != NULL) {
+        struct bloque_arena* siguiente = bloque->siguiente;
+        free(bloque);
+        bloque = siguiente;
+    }
+    arena->bloques->siguiente = NULL;
+    arena->bloques->usado = 0;
+}
+
+/*libera todos los bloques de la arena de una sola vez
+E: arena
+S: void
+R: que la arena haya sido iniciada
+*/
+void liberar_arena(struct arena* arena) {
+    if (arena == NULL) return;
+
+    struct bloque_arena* bloque = arena->bloques;
+    while (bloque != NULL) {
+        struct bloque_arena* siguiente = bloque->siguiente;
+        free(bloque);
+        bloque = siguiente;
+    }
+    arena->bloques = NULL;
+}
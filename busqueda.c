@@ -0,0 +1,691 @@
+#include "heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/stat.h>  // stat, fstat
+#include <unistd.h>    // close
+
+#define MAGIA_BUSQUEDA   "ORDBUSCA"
+#define VERSION_BUSQUEDA 2
+#define LARGO_TERMINO    64 // bytes maximos de un termino (los mas largos se cortan)
+
+//encabezado del archivo del índice invertido; despues viene el bloque tal como esta en memoria
+struct encabezado_busqueda {
+    char magia[8];
+    uint32_t version;
+    uint32_t total;            // artículos del corpus cuando se armo
+    uint64_t tamano_fuente;    // tamaño y fecha del índice de texto
+    int64_t mtime_segundos;
+    int64_t mtime_nanos;
+    uint32_t terminos;
+    uint32_t capacidad_tabla;
+    uint64_t bytes_textos;
+    uint64_t bytes_postings;
+};
+
+//índice invertido: para cada termino, los artículos donde aparece (en el titulo o el resumen)
+//como diferencias entre indices consecutivos en varint (1 byte para las diferencias < 128).
+//todo vive en un solo bloque con el mismo formato del archivo, asi guardarlo es un fwrite y cargarlo un mmap
+struct indice_busqueda {
+    uint32_t terminos;
+    uint32_t capacidad_tabla;         // potencia de 2
+    uint64_t bytes_textos;
+    uint64_t bytes_postings;
+    const uint64_t* inicio_texto;     // terminos + 1, posicion de cada termino en textos
+    const uint64_t* inicio_postings;  // terminos + 1, posicion de su lista en postings
+    const uint32_t* tabla;            // tabla hash con direccionamiento abierto: termino + 1, 0 = vacia
+    const uint32_t* frecuencias;      // en cuantos artículos aparece cada termino
+    const char* textos;
+    const unsigned char* postings;
+    void* bloque;                     // memoria propia (NULL si viene del archivo mapeado)
+    void* mapa;
+    size_t largo_mapa;
+};
+
+//hash FNV-1a de un termino
+static uint64_t hash_termino(const char* termino, size_t largo) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < largo; i++) {
+        hash ^= (unsigned char) termino[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*tamaño del bloque con sus secciones (las de 8 bytes primero, asi todas quedan alineadas)
+E: cantidad de terminos, capacidad de la tabla, bytes de textos y de postings
+S: bytes del bloque
+R: ninguna
+*/
+static size_t tamano_bloque(uint32_t terminos, uint32_t capacidad, uint64_t textos, uint64_t postings) {
+    return 2 * ((size_t) terminos + 1) * sizeof(uint64_t) + ((size_t) capacidad + terminos) * sizeof(uint32_t) +
+           (size_t) textos + (size_t) postings;
+}
+
+/*apunta las secciones del índice dentro de un bloque (propio o mapeado)
+E: indice con los tamaños ya puestos, inicio del bloque
+S: void
+R: que el bloque tenga tamano_bloque bytes
+*/
+static void ubicar_secciones(struct indice_busqueda* indice, const unsigned char* base) {
+    indice->inicio_texto = (const uint64_t*) base;
+    indice->inicio_postings = indice->inicio_texto + indice->terminos + 1;
+    indice->tabla = (const uint32_t*) (indice->inicio_postings + indice->terminos + 1);
+    indice->frecuencias = indice->tabla + indice->capacidad_tabla;
+    indice->textos = (const char*) (indice->frecuencias + indice->terminos);
+    indice->postings = (const unsigned char*) indice->textos + indice->bytes_textos;
+}
+
+//un termino mientras se arma el índice: su lista crece en su propio buffer
+struct termino_armado {
+    const char* texto; // en la arena del armado
+    size_t largo;
+    uint64_t hash;
+    uint32_t ultimo;   // ultimo artículo agregado + 1 (0 = ninguno), para no repetirlo
+    uint32_t frecuencia;
+    unsigned char* lista;
+    size_t usado;
+    size_t capacidad;
+};
+
+struct armado {
+    struct termino_armado* terminos;
+    uint32_t cantidad;
+    uint32_t capacidad;
+    uint32_t* tabla;   // termino + 1, 0 = vacia
+    uint32_t capacidad_tabla;
+    uint64_t bytes_textos;
+    uint64_t bytes_postings;
+    struct arena textos;
+};
+
+/*escribe un numero en varint: 7 bits por byte, el bit alto prendido si siguen mas bytes
+E: destino (con al menos 5 bytes libres), numero
+S: bytes escritos
+R: ninguna
+*/
+static size_t escribir_varint(unsigned char* destino, uint32_t numero) {
+    size_t bytes = 0;
+    while (numero >= 0x80) {
+        destino[bytes++] = (unsigned char) (numero | 0x80);
+        numero >>= 7;
+    }
+    destino[bytes++] = (unsigned char) numero;
+    return bytes;
+}
+
+static inline uint32_t leer_varint(const unsigned char** actual) {
+    const unsigned char* p = *actual;
+    uint32_t numero = *p & 0x7F;
+    int corrimiento = 7;
+    while (*p++ & 0x80) {
+        numero |= (uint32_t) (*p & 0x7F) << corrimiento;
+        corrimiento += 7;
+    }
+    *actual = p;
+    return numero;
+}
+
+/*duplica la tabla hash del armado y vuelve a meter todos los terminos
+E: armado
+S: 1 si salio bien, 0 si no hubo memoria
+R: ninguna
+*/
+static int crecer_tabla(struct armado* armado) {
+    uint32_t capacidad = armado->capacidad_tabla ? armado->capacidad_tabla * 2 : 1024;
+    uint32_t* tabla = calloc(capacidad, sizeof(uint32_t));
+    if (tabla == NULL) return 0;
+
+    for (uint32_t t = 0; t < armado->cantidad; t++) {
+        uint32_t ranura = (uint32_t) armado->terminos[t].hash & (capacidad - 1);
+        while (tabla[ranura] != 0) ranura = (ranura + 1) & (capacidad - 1);
+        tabla[ranura] = t + 1;
+    }
+    free(armado->tabla);
+    armado->tabla = tabla;
+    armado->capacidad_tabla = capacidad;
+    return 1;
+}
+
+/*agrega una aparicion de un termino en un artículo (si ya estaba en ese artículo no hace nada)
+E: armado, termino, largo, indice del artículo
+S: 1 si salio bien, 0 si no hubo memoria
+R: que los artículos se agreguen en orden creciente
+*/
+static int agregar_aparicion(struct armado* armado, const char* termino, size_t largo, uint32_t articulo) {
+    if ((armado->cantidad + 1) * 2 > armado->capacidad_tabla && !crecer_tabla(armado)) return 0;
+
+    uint64_t hash = hash_termino(termino, largo);
+    uint32_t ranura = (uint32_t) hash & (armado->capacidad_tabla - 1);
+    struct termino_armado* actual = NULL;
+    while (armado->tabla[ranura] != 0) {
+        struct termino_armado* candidato = &armado->terminos[armado->tabla[ranura] - 1];
+        if (candidato->hash == hash && candidato->largo == largo && memcmp(candidato->texto, termino, largo) == 0) {
+            actual = candidato;
+            break;
+        }
+        ranura = (ranura + 1) & (armado->capacidad_tabla - 1);
+    }
+
+    if (actual == NULL) {
+        if (armado->cantidad == armado->capacidad) {
+            uint32_t nueva = armado->capacidad ? armado->capacidad * 2 : 1024;
+            struct termino_armado* terminos = realloc(armado->terminos, nueva * sizeof(struct termino_armado));
+            if (terminos == NULL) return 0;
+            armado->terminos = terminos;
+            armado->capacidad = nueva;
+        }
+        char* texto = arena_copiar(&armado->textos, termino, largo);
+        if (texto == NULL) return 0;
+        actual = &armado->terminos[armado->cantidad];
+        *actual = (struct termino_armado) {texto, largo, hash, 0, 0, NULL, 0, 0};
+        armado->tabla[ranura] = ++armado->cantidad;
+        armado->bytes_textos += largo;
+    }
+
+    if (actual->ultimo == articulo + 1) return 1; //ya estaba en este artículo
+    if (actual->usado + 5 > actual->capacidad) {
+        size_t nueva = actual->capacidad ? actual->capacidad * 2 : 16;
+        unsigned char* lista = realloc(actual->lista, nueva);
+        if (lista == NULL) return 0;
+        actual->lista = lista;
+        actual->capacidad = nueva;
+    }
+    //diferencia con el artículo anterior (el primero se guarda completo)
+    uint32_t anterior = actual->ultimo ? actual->ultimo - 1 : 0;
+    size_t escritos = escribir_varint(actual->lista + actual->usado, articulo - anterior);
+    actual->usado += escritos;
+    armado->bytes_postings += escritos;
+    actual->ultimo = articulo + 1;
+    actual->frecuencia++;
+    return 1;
+}
+
+/*agrega todos los terminos de un texto
+E: armado, texto (puede ser NULL), indice del artículo
+S: 1 si salio bien, 0 si no hubo memoria
+R: ninguna
+*/
+static int indexar_texto(struct armado* armado, const char* texto, uint32_t articulo) {
+    char termino[LARGO_TERMINO + 1];
+    size_t largo;
+    while (texto != NULL && (texto = siguiente_termino(texto, termino, sizeof(termino), &largo)) != NULL) {
+        if (!agregar_aparicion(armado, termino, largo, articulo)) return 0;
+    }
+    return 1;
+}
+
+static void liberar_armado(struct armado* armado) {
+    for (uint32_t t = 0; t < armado->cantidad; t++) {
+        free(armado->terminos[t].lista);
+    }
+    free(armado->terminos);
+    free(armado->tabla);
+    liberar_arena(&armado->textos);
+}
+
+/*pasa el armado a un bloque compacto: las listas y los textos uno detras de otro
+E: armado
+S: índice nuevo, NULL si no hubo memoria
+R: ninguna
+*/
+static struct indice_busqueda* compactar(const struct armado* armado) {
+    struct indice_busqueda* indice = calloc(1, sizeof(struct indice_busqueda));
+    if (indice == NULL) return NULL;
+    indice->terminos = armado->cantidad;
+    indice->capacidad_tabla = armado->capacidad_tabla;
+    indice->bytes_textos = armado->bytes_textos;
+    indice->bytes_postings = armado->bytes_postings;
+
+    size_t tamano = tamano_bloque(indice->terminos, indice->capacidad_tabla, indice->bytes_textos, indice->bytes_postings);
+    unsigned char* bloque = malloc(tamano > 0 ? tamano : 1);
+    if (bloque == NULL) {
+        free(indice);
+        return NULL;
+    }
+    indice->bloque = bloque;
+    ubicar_secciones(indice, bloque);
+
+    //las secciones se llenan por sus punteros (en el bloque propio se pueden escribir)
+    uint64_t* inicio_texto = (uint64_t*) indice->inicio_texto;
+    uint64_t* inicio_postings = (uint64_t*) indice->inicio_postings;
+    uint32_t* frecuencias = (uint32_t*) indice->frecuencias;
+    char* textos = (char*) indice->textos;
+    unsigned char* postings = (unsigned char*) indice->postings;
+
+    uint64_t posicion_texto = 0;
+    uint64_t posicion_postings = 0;
+    for (uint32_t t = 0; t < armado->cantidad; t++) {
+        const struct termino_armado* termino = &armado->terminos[t];
+        inicio_texto[t] = posicion_texto;
+        inicio_postings[t] = posicion_postings;
+        frecuencias[t] = termino->frecuencia;
+        memcpy(textos + posicion_texto, termino->texto, termino->largo);
+        memcpy(postings + posicion_postings, termino->lista, termino->usado);
+        posicion_texto += termino->largo;
+        posicion_postings += termino->usado;
+    }
+    inicio_texto[armado->cantidad] = posicion_texto;
+    inicio_postings[armado->cantidad] = posicion_postings;
+    if (armado->capacidad_tabla > 0) {
+        memcpy((uint32_t*) indice->tabla, armado->tabla, armado->capacidad_tabla * sizeof(uint32_t));
+    }
+    return indice;
+}
+
+/*arma el índice invertido recorriendo el titulo y el resumen de cada artículo una vez
+E: corpus
+S: índice nuevo, NULL si falla
+R: que el corpus este cargado
+*/
+static struct indice_busqueda* armar_indice_busqueda(const struct corpus* corpus) {
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+
+    struct armado armado;
+    memset(&armado, 0, sizeof(armado));
+    iniciar_arena(&armado.textos, 0);
+    int bien = crecer_tabla(&armado);
+    for (int i = 0; bien && i < corpus->total; i++) {
+        bien = indexar_texto(&armado, corpus->articulos[i].titulo_articulo, (uint32_t) i) &&
+               indexar_texto(&armado, corpus->articulos[i].resumen, (uint32_t) i);
+    }
+    struct indice_busqueda* indice = bien ? compactar(&armado) : NULL;
+    liberar_armado(&armado);
+
+    terminar_fase(FASE_INDICES, &marca);
+    if (indice == NULL) {
+        fprintf(stderr, "Error: no hay memoria para el indice de busqueda.\n");
+    }
+    return indice;
+}
+
+/*libera el índice invertido del corpus (se vuelve a armar con la proxima busqueda)
+E: corpus
+S: void
+R: ninguna
+*/
+void liberar_indice_busqueda(struct corpus* corpus) {
+    struct indice_busqueda* indice = corpus->busqueda;
+    if (indice == NULL) return;
+
+    free(indice->bloque);
+    if (indice->mapa != NULL) munmap(indice->mapa, indice->largo_mapa);
+    free(indice);
+    corpus->busqueda = NULL;
+}
+
+/*busca un termino en la tabla hash
+E: índice, termino, largo
+S: numero del termino, -1 si no esta
+R: ninguna
+*/
+static long buscar_termino(const struct indice_busqueda* indice, const char* termino, size_t largo) {
+    if (indice->capacidad_tabla == 0) return -1;
+    uint32_t ranura = (uint32_t) hash_termino(termino, largo) & (indice->capacidad_tabla - 1);
+    while (indice->tabla[ranura] != 0) {
+        uint32_t t = indice->tabla[ranura] - 1;
+        uint64_t inicio = indice->inicio_texto[t];
+        if (indice->inicio_texto[t + 1] - inicio == largo && memcmp(indice->textos + inicio, termino, largo) == 0) {
+            return t;
+        }
+        ranura = (ranura + 1) & (indice->capacidad_tabla - 1);
+    }
+    return -1;
+}
+
+/*deja en resultado solo los artículos que tambien estan en la lista del termino: se recorren
+las dos listas ordenadas a la vez, decodificando la del termino sobre la marcha
+E: índice, termino, resultado (indices crecientes), cantidad
+S: nueva cantidad
+R: que el termino exista
+*/
+static int intersecar(const struct indice_busqueda* indice, uint32_t termino, uint32_t* resultado, int cantidad) {
+    const unsigned char* lista = indice->postings + indice->inicio_postings[termino];
+    uint32_t restantes = indice->frecuencias[termino];
+    uint32_t articulo = 0;
+    int quedan = 0;
+    int i = 0;
+    while (i < cantidad && restantes > 0) {
+        articulo += leer_varint(&lista);
+        restantes--;
+        while (i < cantidad && resultado[i] < articulo) i++;
+        if (i < cantidad && resultado[i] == articulo) resultado[quedan++] = resultado[i++];
+    }
+    return quedan;
+}
+
+/*artículos donde aparecen todos los terminos de un grupo (la lista mas corta se decodifica entera
+y las demas se intersecan contra ella, de la mas corta a la mas larga)
+E: índice, terminos del grupo, cuantos, cantidad (salida)
+S: arreglo nuevo con indices crecientes, NULL si no hubo memoria
+R: que haya al menos un termino
+*/
+static uint32_t* buscar_grupo(const struct indice_busqueda* indice, const long* terminos, int cuantos, int* cantidad) {
+    *cantidad = 0;
+    for (int t = 0; t < cuantos; t++) {
+        if (terminos[t] < 0) return malloc(sizeof(uint32_t)); //un termino que no esta: no hay resultados
+    }
+
+    //ordenar los terminos por frecuencia (son pocos)
+    long ordenados[cuantos];
+    memcpy(ordenados, terminos, sizeof(ordenados));
+    for (int a = 1; a < cuantos; a++) {
+        long actual = ordenados[a];
+        int b = a - 1;
+        while (b >= 0 && indice->frecuencias[ordenados[b]] > indice->frecuencias[actual]) {
+            ordenados[b + 1] = ordenados[b];
+            b--;
+        }
+        ordenados[b + 1] = actual;
+    }
+
+    uint32_t frecuencia = indice->frecuencias[ordenados[0]];
+    uint32_t* resultado = malloc((frecuencia > 0 ? frecuencia : 1) * sizeof(uint32_t));
+    if (resultado == NULL) return NULL;
+    const unsigned char* lista = indice->postings + indice->inicio_postings[ordenados[0]];
+    uint32_t articulo = 0;
+    for (uint32_t i = 0; i < frecuencia; i++) {
+        articulo += leer_varint(&lista);
+        resultado[i] = articulo;
+    }
+
+    int quedan = (int) frecuencia;
+    for (int t = 1; t < cuantos && quedan > 0; t++) {
+        quedan = intersecar(indice, (uint32_t) ordenados[t], resultado, quedan);
+    }
+    *cantidad = quedan;
+    return resultado;
+}
+
+/*une dos listas crecientes sin repetir
+E: listas a y b con sus cantidades, cantidad (salida)
+S: arreglo nuevo, NULL si no hubo memoria
+R: ninguna
+*/
+static uint32_t* unir(const uint32_t* a, int na, const uint32_t* b, int nb, int* cantidad) {
+    uint32_t* union_ = malloc(((size_t) na + nb + 1) * sizeof(uint32_t));
+    if (union_ == NULL) return NULL;
+    int i = 0, j = 0, k = 0;
+    while (i < na || j < nb) {
+        if (j >= nb || (i < na && a[i] < b[j])) {
+            union_[k++] = a[i++];
+        } else if (i >= na || b[j] < a[i]) {
+            union_[k++] = b[j++];
+        } else {
+            union_[k++] = a[i++];
+            j++;
+        }
+    }
+    *cantidad = k;
+    return union_;
+}
+
+/*busca en el titulo y el resumen: las palabras seguidas tienen que estar todas (AND) y "OR" o "|"
+separa alternativas, por ejemplo "impunidad Brasil OR gobernabilidad"; sin importar mayusculas ni tildes,
+pero la ñ es una letra aparte igual que en --titulo ("año" no encuentra "ano", ver siguiente_termino)
+E: corpus, consulta, cantidad (donde guardar cuantos artículos cumplen)
+S: arreglo nuevo con los indices en orden creciente (hay que liberarlo), NULL si falla
+R: que el corpus este cargado
+*/
+uint32_t* corpus_buscar(struct corpus* corpus, const char* consulta, int* cantidad) {
+    *cantidad = 0;
+    if (corpus->busqueda == NULL) {
+        corpus->busqueda = armar_indice_busqueda(corpus);
+        if (corpus->busqueda == NULL) return NULL;
+    }
+    const struct indice_busqueda* indice = corpus->busqueda;
+
+    //copia de la consulta para separarla por espacios
+    char* copia = strdup(consulta);
+    if (copia == NULL) return NULL;
+
+    //cada termino ocupa al menos un byte y lo separa del siguiente otro byte, asi que en un grupo
+    //no puede haber mas de largo / 2 + 1 terminos: ninguno se deja afuera
+    uint32_t* resultado = malloc(sizeof(uint32_t));
+    int total_resultado = 0;
+    long* terminos = malloc((strlen(copia) / 2 + 1) * sizeof(long));
+    int cuantos = 0;
+    int bien = (resultado != NULL && terminos != NULL);
+
+    char* resto = NULL;
+    char* palabra = strtok_r(copia, " \t\r\n", &resto);
+    while (bien) {
+        int fin_grupo = (palabra == NULL || strcmp(palabra, "OR") == 0 || strcmp(palabra, "|") == 0);
+        if (!fin_grupo) {
+            char termino[LARGO_TERMINO + 1];
+            size_t largo;
+            const char* texto = palabra;
+            while ((texto = siguiente_termino(texto, termino, sizeof(termino), &largo)) != NULL) {
+                terminos[cuantos++] = buscar_termino(indice, termino, largo);
+            }
+        } else if (cuantos > 0) {
+            int cantidad_grupo;
+            uint32_t* grupo = buscar_grupo(indice, terminos, cuantos, &cantidad_grupo);
+            uint32_t* unidos = (grupo != NULL) ? unir(resultado, total_resultado, grupo, cantidad_grupo, &total_resultado) : NULL;
+            free(grupo);
+            free(resultado);
+            resultado = unidos;
+            bien = (resultado != NULL);
+            cuantos = 0;
+        }
+        if (palabra == NULL) break;
+        palabra = strtok_r(NULL, " \t\r\n", &resto);
+    }
+    free(copia);
+    free(terminos);
+    if (!bien) {
+        free(resultado);
+        return NULL;
+    }
+
+    *cantidad = total_resultado;
+    return resultado;
+}
+
+/*arma la ruta del índice de busqueda (el nombre del índice de texto terminado en .busqueda)
+E: nombre del índice
+S: ruta nueva (hay que liberarla), NULL si falla
+R: ninguna
+*/
+static char* ruta_busqueda(const char* nombre_archivo) {
+    size_t largo = strlen(nombre_archivo);
+    char* ruta = malloc(largo + sizeof(".busqueda"));
+    if (ruta != NULL) {
+        memcpy(ruta, nombre_archivo, largo);
+        memcpy(ruta + largo, ".busqueda", sizeof(".busqueda"));
+    }
+    return ruta;
+}
+
+/*guarda el índice de busqueda junto al índice de texto (encabezado + bloque), por un temporal y rename
+E: índice, ruta, total de artículos, stat del índice de texto
+S: 1 si salio bien, 0 si no
+R: ninguna
+*/
+static int guardar_indice_busqueda(const struct indice_busqueda* indice, const char* ruta, int total,
+                                   const struct stat* fuente) {
+    struct encabezado_busqueda encabezado;
+    memset(&encabezado, 0, sizeof(encabezado));
+    memcpy(encabezado.magia, MAGIA_BUSQUEDA, 8);
+    encabezado.version = VERSION_BUSQUEDA;
+    encabezado.total = (uint32_t) total;
+    encabezado.tamano_fuente = (uint64_t) fuente->st_size;
+    encabezado.mtime_segundos = (int64_t) fuente->st_mtim.tv_sec;
+    encabezado.mtime_nanos = (int64_t) fuente->st_mtim.tv_nsec;
+    encabezado.terminos = indice->terminos;
+    encabezado.capacidad_tabla = indice->capacidad_tabla;
+    encabezado.bytes_textos = indice->bytes_textos;
+    encabezado.bytes_postings = indice->bytes_postings;
+
+    size_t largo_ruta = strlen(ruta);
+    char* temporal = malloc(largo_ruta + sizeof(".tmp"));
+    if (temporal == NULL) return 0;
+    memcpy(temporal, ruta, largo_ruta);
+    memcpy(temporal + largo_ruta, ".tmp", sizeof(".tmp"));
+
+    FILE* archivo = fopen(temporal, "wb");
+    if (archivo == NULL) {
+        fprintf(stderr, "Advertencia: no se pudo crear el indice de busqueda %s\n", ruta);
+        free(temporal);
+        return 0;
+    }
+    size_t tamano = tamano_bloque(indice->terminos, indice->capacidad_tabla, indice->bytes_textos, indice->bytes_postings);
+    int bien = (fwrite(&encabezado, sizeof(encabezado), 1, archivo) == 1) &&
+               (tamano == 0 || fwrite(indice->inicio_texto, tamano, 1, archivo) == 1);
+    if (fclose(archivo) != 0) bien = 0;
+    if (bien && rename(temporal, ruta) != 0) bien = 0;
+    if (!bien) {
+        fprintf(stderr, "Advertencia: no se pudo escribir el indice de busqueda %s\n", ruta);
+        remove(temporal);
+    }
+    free(temporal);
+    return bien;
+}
+
+/*revisa que el bloque del encabezado ocupe justo el resto del archivo, sin desbordar las cuentas
+E: encabezado, largo del archivo
+S: 1 si el tamaño cuadra, 0 si no
+R: que el archivo tenga al menos el encabezado
+*/
+static int tamano_valido(const struct encabezado_busqueda* encabezado, size_t largo) {
+    //terminos y capacidad son de 32 bits: estas dos cuentas caben en 64 bits
+    uint64_t fijos = 2 * ((uint64_t) encabezado->terminos + 1) * sizeof(uint64_t) +
+                     ((uint64_t) encabezado->capacidad_tabla + encabezado->terminos) * sizeof(uint32_t);
+    uint64_t disponibles = (uint64_t) largo - sizeof(*encabezado);
+    if (fijos > disponibles) return 0;
+    disponibles -= fijos;
+    if (encabezado->bytes_textos > disponibles) return 0;
+    return encabezado->bytes_postings == disponibles - encabezado->bytes_textos;
+}
+
+/*revisa lo que buscar_termino e intersecar usan sin mirar, asi un .busqueda dañado que conserva el
+tamaño se vuelve a armar en vez de leer fuera del mapa o quedarse dando vueltas en la tabla:
+la tabla es potencia de 2 con al menos una ranura vacia y solo apunta a terminos que existen, las
+posiciones de textos y listas crecen y terminan justo al final de su seccion, y cada lista se puede
+decodificar dentro de sus bytes con artículos crecientes y menores a total
+E: índice con las secciones ubicadas, total de artículos
+S: 1 si es valido, 0 si no
+R: que el bloque tenga el tamaño del encabezado (ver tamano_valido)
+*/
+static int indice_valido(const struct indice_busqueda* indice, int total) {
+    uint32_t capacidad = indice->capacidad_tabla;
+    if (capacidad == 0) {
+        if (indice->terminos != 0) return 0; //corpus sin terminos: buscar_termino no mira la tabla
+    } else if ((capacidad & (capacidad - 1)) != 0) {
+        return 0;
+    }
+    int hay_vacia = (capacidad == 0);
+    for (uint32_t i = 0; i < capacidad; i++) {
+        if (indice->tabla[i] > indice->terminos) return 0;
+        if (indice->tabla[i] == 0) hay_vacia = 1;
+    }
+    if (!hay_vacia) return 0;
+
+    if (indice->inicio_texto[0] != 0 || indice->inicio_postings[0] != 0) return 0;
+    for (uint32_t t = 0; t < indice->terminos; t++) {
+        if (indice->inicio_texto[t + 1] < indice->inicio_texto[t]) return 0;
+        if (indice->inicio_postings[t + 1] < indice->inicio_postings[t]) return 0;
+    }
+    if (indice->inicio_texto[indice->terminos] != indice->bytes_textos) return 0;
+    if (indice->inicio_postings[indice->terminos] != indice->bytes_postings) return 0;
+
+    for (uint32_t t = 0; t < indice->terminos; t++) {
+        const unsigned char* actual = indice->postings + indice->inicio_postings[t];
+        const unsigned char* fin = indice->postings + indice->inicio_postings[t + 1];
+        uint64_t articulo = 0;
+        for (uint32_t f = 0; f < indice->frecuencias[t]; f++) {
+            //el mismo varint que leer_varint, pero sin pasarse del final de la lista
+            uint64_t diferencia = 0;
+            int corrimiento = 0;
+            unsigned char byte;
+            do {
+                if (actual == fin || corrimiento > 28) return 0;
+                byte = *actual++;
+                diferencia |= (uint64_t) (byte & 0x7F) << corrimiento;
+                corrimiento += 7;
+            } while (byte & 0x80);
+            if (f > 0 && diferencia == 0) return 0;
+            articulo += diferencia;
+            if (articulo >= (uint64_t) total) return 0;
+        }
+    }
+    return 1;
+}
+
+/*mapea el índice de busqueda guardado si corresponde al índice de texto y al corpus actual
+E: ruta, total de artículos, stat del índice de texto
+S: índice (las secciones apuntan al mapa), NULL si no existe, esta viejo o dañado
+R: ninguna
+*/
+static struct indice_busqueda* mapear_indice_busqueda(const char* ruta, int total, const struct stat* fuente) {
+    int fd = open(ruta, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(struct encabezado_busqueda)) {
+        close(fd);
+        return NULL;
+    }
+    size_t largo = (size_t) info.st_size;
+    void* mapa = mmap(NULL, largo, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) return NULL;
+
+    const struct encabezado_busqueda* encabezado = mapa;
+    int vigente = memcmp(encabezado->magia, MAGIA_BUSQUEDA, 8) == 0 && encabezado->version == VERSION_BUSQUEDA &&
+                  encabezado->total == (uint32_t) total && encabezado->tamano_fuente == (uint64_t) fuente->st_size &&
+                  encabezado->mtime_segundos == (int64_t) fuente->st_mtim.tv_sec &&
+                  encabezado->mtime_nanos == (int64_t) fuente->st_mtim.tv_nsec && tamano_valido(encabezado, largo);
+    struct indice_busqueda* indice = vigente ? calloc(1, sizeof(struct indice_busqueda)) : NULL;
+    if (indice == NULL) {
+        munmap(mapa, largo);
+        return NULL;
+    }
+    indice->terminos = encabezado->terminos;
+    indice->capacidad_tabla = encabezado->capacidad_tabla;
+    indice->bytes_textos = encabezado->bytes_textos;
+    indice->bytes_postings = encabezado->bytes_postings;
+    ubicar_secciones(indice, (const unsigned char*) mapa + sizeof(*encabezado));
+    if (!indice_valido(indice, total)) {
+        free(indice);
+        munmap(mapa, largo);
+        return NULL;
+    }
+    indice->mapa = mapa;
+    indice->largo_mapa = largo;
+    sumar_bytes_leidos(largo);
+    return indice;
+}
+
+/*deja listo el índice de busqueda del corpus: lo mapea del archivo .busqueda si esta al dia,
+y si no lo arma y (con guardar = 1) lo escribe para la proxima vez
+E: corpus, nombre del índice de texto, guardar
+S: 1 si el índice quedo listo, 0 si no
+R: que el corpus se haya cargado de ese archivo
+*/
+int preparar_indice_busqueda(struct corpus* corpus, const char* nombre_archivo, int guardar) {
+    if (corpus->busqueda != NULL) return 1;
+
+    struct stat fuente;
+    char* ruta = ruta_busqueda(nombre_archivo);
+    if (ruta == NULL || stat(nombre_archivo, &fuente) != 0 || (size_t) fuente.st_size != corpus->bytes_fuente) {
+        //sin ruta o con el archivo cambiado solo se arma en memoria
+        free(ruta);
+        corpus->busqueda = armar_indice_busqueda(corpus);
+        return corpus->busqueda != NULL;
+    }
+
+    if (guardar) {
+        corpus->busqueda = mapear_indice_busqueda(ruta, corpus->total, &fuente);
+    }
+    if (corpus->busqueda == NULL) {
+        corpus->busqueda = armar_indice_busqueda(corpus);
+        if (corpus->busqueda != NULL && guardar) {
+            guardar_indice_busqueda(corpus->busqueda, ruta, corpus->total, &fuente);
+        }
+    }
+    free(ruta);
+    return corpus->busqueda != NULL;
+}
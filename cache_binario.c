@@ -0,0 +1,369 @@
+#include "heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/stat.h>  // stat, fstat
+#include <unistd.h>    // close
+
+#define MAGIA_CACHE   "ORDCACHE"
+#define VERSION_CACHE 4 // 4: los empates de las permutaciones guardadas van por indice
+#define CAMPOS_TEXTO  5           // nombre, apellido, titulo, ruta, resumen
+#define SIN_CADENA    UINT64_MAX  // desplazamiento de un campo que venia vacio (NULL)
+
+//encabezado del archivo de cache; todas las posiciones son en bytes desde el inicio del archivo
+struct encabezado_cache {
+    char magia[8];
+    uint32_t version;
+    uint32_t total;            // cantidad de artículos
+    uint64_t tamano_fuente;    // tamaño del archivo de texto cuando se armo la cache
+    int64_t mtime_segundos;    // fecha de modificacion del archivo de texto
+    int64_t mtime_nanos;
+    uint64_t bytes_completos;  // bytes hasta el ultimo '\n' (donde sigue la recarga incremental)
+    uint32_t cola_cargada;     // 1 si se guardo tambien una ultima línea sin '\n'
+    uint32_t reservado;
+    uint64_t pos_anos;         // int32_t[total]
+    uint64_t pos_palabras;     // int32_t[total]
+    uint64_t pos_desplazamientos; // uint64_t[total * CAMPOS_TEXTO], relativos a pos_cadenas
+    uint64_t pos_cadenas;      // todas las cadenas terminadas en '\0', una detras de otra
+    uint64_t bytes_cadenas;
+    uint64_t pos_ordenes[TOTAL_CRITERIOS]; // uint32_t[total] por criterio: la permutacion ya ordenada
+};
+
+/*arma la ruta del archivo de cache de un índice (el mismo nombre terminado en .cache)
+E: nombre del índice
+S: ruta nueva en memoria (hay que liberarla), NULL si falla
+R: que el nombre no sea NULL
+*/
+char* ruta_cache_binario(const char* nombre_archivo) {
+    size_t largo = strlen(nombre_archivo);
+    char* ruta = malloc(largo + sizeof(".cache"));
+    if (ruta != NULL) {
+        memcpy(ruta, nombre_archivo, largo);
+        memcpy(ruta + largo, ".cache", sizeof(".cache"));
+    }
+    return ruta;
+}
+
+/*devuelve los campos de texto de un artículo en el orden en que se guardan en la cache
+E: articulo, arreglo de CAMPOS_TEXTO punteros
+S: void
+R: ninguna
+*/
+static void campos_de_articulo(const struct articulo* art, const char* campos[CAMPOS_TEXTO]) {
+    campos[0] = art->nombre_autor;
+    campos[1] = art->apellido_autor;
+    campos[2] = art->titulo_articulo;
+    campos[3] = art->ruta;
+    campos[4] = art->resumen;
+}
+
+/*guarda el corpus en un archivo binario por columnas para que la proxima vez se cargue con mmap,
+junto con la permutacion completa de cada criterio (se ordena aca si todavia no estaba ordenado)
+E: corpus (con sus columnas derivadas), ruta de la cache, informacion del archivo fuente (stat)
+S: 1 si salio bien, 0 si no
+R: ninguna
+*/
+int guardar_cache_binario(struct corpus* corpus, const char* ruta_cache, const struct stat* fuente) {
+    //las columnas derivadas se guardan tal cual, asi al mapear la cache no se recalcula nada
+    for (int c = 0; c < TOTAL_COLUMNAS; c++) {
+        if (corpus->columnas[c] == NULL && !calcular_columnas_derivadas(corpus, 0)) return 0;
+    }
+
+    //los cuatro ordenamientos completos: se pagan una vez al armar la cache y no en cada consulta
+    const uint32_t* ordenes[TOTAL_CRITERIOS] = {NULL};
+    for (int c = 0; c < TOTAL_CRITERIOS && corpus->total > 0; c++) {
+        ordenes[c] = corpus_obtener_orden(corpus, (enum criterio_orden) c, corpus->total);
+        if (ordenes[c] == NULL) {
+            fprintf(stderr, "Advertencia: no se pudo ordenar para la cache %s\n", ruta_cache);
+            return 0;
+        }
+    }
+
+    //se escribe a un archivo temporal y despues se renombra, asi nunca queda una cache a medias
+    size_t largo_ruta = strlen(ruta_cache);
+    char* temporal = malloc(largo_ruta + sizeof(".tmp"));
+    if (temporal == NULL) return 0;
+    memcpy(temporal, ruta_cache, largo_ruta);
+    memcpy(temporal + largo_ruta, ".tmp", sizeof(".tmp"));
+
+    FILE* archivo = fopen(temporal, "wb");
+    if (archivo == NULL) {
+        fprintf(stderr, "Advertencia: no se pudo crear la cache %s\n", ruta_cache);
+        free(temporal);
+        return 0;
+    }
+
+    uint32_t n = (uint32_t) corpus->total;
+    struct encabezado_cache encabezado;
+    memset(&encabezado, 0, sizeof(encabezado));
+    memcpy(encabezado.magia, MAGIA_CACHE, 8);
+    encabezado.version = VERSION_CACHE;
+    encabezado.total = n;
+    encabezado.tamano_fuente = (uint64_t) fuente->st_size;
+    encabezado.mtime_segundos = (int64_t) fuente->st_mtim.tv_sec;
+    encabezado.mtime_nanos = (int64_t) fuente->st_mtim.tv_nsec;
+    encabezado.bytes_completos = (uint64_t) corpus->bytes_fuente;
+    encabezado.cola_cargada = (uint32_t) corpus->cola_cargada;
+    encabezado.pos_anos = sizeof(encabezado);
+    encabezado.pos_palabras = encabezado.pos_anos + (uint64_t) n * sizeof(int32_t);
+    encabezado.pos_desplazamientos = encabezado.pos_palabras + (uint64_t) n * sizeof(int32_t);
+    encabezado.pos_desplazamientos = (encabezado.pos_desplazamientos + 7) & ~(uint64_t) 7;
+    encabezado.pos_cadenas = encabezado.pos_desplazamientos + (uint64_t) n * CAMPOS_TEXTO * sizeof(uint64_t);
+    //las permutaciones van antes de las cadenas para que queden alineadas
+    for (int c = 0; c < TOTAL_CRITERIOS; c++) {
+        encabezado.pos_ordenes[c] = encabezado.pos_cadenas;
+        encabezado.pos_cadenas += (uint64_t) n * sizeof(uint32_t);
+    }
+
+    int bien = (fwrite(&encabezado, sizeof(encabezado), 1, archivo) == 1);
+
+    //columnas de largo fijo
+    for (uint32_t i = 0; bien && i < n; i++) {
+        int32_t ano = corpus->columnas[COLUMNA_ANO][i];
+        bien = (fwrite(&ano, sizeof(ano), 1, archivo) == 1);
+    }
+    for (uint32_t i = 0; bien && i < n; i++) {
+        int32_t palabras = corpus->columnas[COLUMNA_PALABRAS_TITULO][i];
+        bien = (fwrite(&palabras, sizeof(palabras), 1, archivo) == 1);
+    }
+    long relleno = (long) (encabezado.pos_desplazamientos - (encabezado.pos_palabras + (uint64_t) n * sizeof(int32_t)));
+    for (long i = 0; bien && i < relleno; i++) {
+        bien = (fputc(0, archivo) != EOF);
+    }
+
+    //tabla de desplazamientos de cada cadena
+    uint64_t posicion = 0;
+    for (uint32_t i = 0; bien && i < n; i++) {
+        const char* campos[CAMPOS_TEXTO];
+        campos_de_articulo(&corpus->articulos[i], campos);
+        for (int c = 0; bien && c < CAMPOS_TEXTO; c++) {
+            uint64_t desplazamiento = SIN_CADENA;
+            if (campos[c] != NULL) {
+                desplazamiento = posicion;
+                posicion += strlen(campos[c]) + 1;
+            }
+            bien = (fwrite(&desplazamiento, sizeof(desplazamiento), 1, archivo) == 1);
+        }
+    }
+
+    //las permutaciones de cada criterio
+    for (int c = 0; bien && c < TOTAL_CRITERIOS && n > 0; c++) {
+        bien = (fwrite(ordenes[c], sizeof(uint32_t), n, archivo) == n);
+    }
+
+    //las cadenas
+    for (uint32_t i = 0; bien && i < n; i++) {
+        const char* campos[CAMPOS_TEXTO];
+        campos_de_articulo(&corpus->articulos[i], campos);
+        for (int c = 0; bien && c < CAMPOS_TEXTO; c++) {
+            if (campos[c] != NULL) {
+                bien = (fwrite(campos[c], strlen(campos[c]) + 1, 1, archivo) == 1);
+            }
+        }
+    }
+
+    //ahora si se sabe cuanto ocupan las cadenas
+    encabezado.bytes_cadenas = posicion;
+    if (bien) {
+        bien = (fseek(archivo, 0, SEEK_SET) == 0 && fwrite(&encabezado, sizeof(encabezado), 1, archivo) == 1);
+    }
+    if (fclose(archivo) != 0) bien = 0;
+
+    if (bien && rename(temporal, ruta_cache) != 0) bien = 0;
+    if (!bien) {
+        fprintf(stderr, "Advertencia: no se pudo escribir la cache %s\n", ruta_cache);
+        remove(temporal);
+    }
+    free(temporal);
+    return bien;
+}
+
+/*revisa que una seccion de la cache este entera dentro del archivo y bien alineada
+E: posicion, bytes, alineacion, largo del archivo
+S: 1 si es valida, 0 si no
+R: ninguna
+*/
+static int seccion_valida(uint64_t posicion, uint64_t bytes, uint64_t alineacion, size_t largo) {
+    return posicion <= largo && bytes <= largo - posicion && posicion % alineacion == 0;
+}
+
+/*revisa lo que despues se usa sin mirar: cada permutacion tiene que tener cada indice de artículo
+exactamente una vez y cada desplazamiento tiene que caer dentro de las cadenas (que terminan en '\0'),
+asi una cache dañada que tiene el mismo tamaño y fecha se descarta en vez de leer fuera del mapa
+E: mapa de la cache, su encabezado (con las secciones ya revisadas)
+S: 1 si todo es valido, 0 si no
+R: que las secciones esten dentro del mapa
+*/
+static int contenido_valido(const unsigned char* mapa, const struct encabezado_cache* encabezado) {
+    uint64_t n = encabezado->total;
+    const char* cadenas = (const char*) (mapa + encabezado->pos_cadenas);
+    uint64_t bytes = encabezado->bytes_cadenas;
+    //con la ultima cadena terminada en '\0', cualquier desplazamiento menor a bytes llega a un '\0'
+    if (bytes > 0 && cadenas[bytes - 1] != '\0') return 0;
+
+    const uint64_t* desplazamientos = (const uint64_t*) (mapa + encabezado->pos_desplazamientos);
+    for (uint64_t i = 0; i < n * CAMPOS_TEXTO; i++) {
+        if (desplazamientos[i] != SIN_CADENA && desplazamientos[i] >= bytes) return 0;
+    }
+
+    //cada permutacion tiene que tener cada indice exactamente una vez: con uno repetido se imprimiria
+    //un artículo dos veces y faltaria otro
+    unsigned char* vistos = malloc((size_t) (n + 7) / 8 + 1);
+    if (vistos == NULL) return 0;
+    int bien = 1;
+    for (int c = 0; c < TOTAL_CRITERIOS && n > 0 && bien; c++) {
+        const uint32_t* orden = (const uint32_t*) (mapa + encabezado->pos_ordenes[c]);
+        memset(vistos, 0, (size_t) (n + 7) / 8);
+        for (uint64_t i = 0; i < n && bien; i++) {
+            uint32_t indice = orden[i];
+            unsigned char bit = (unsigned char) (1u << (indice % 8));
+            bien = (indice < n && (vistos[indice / 8] & bit) == 0);
+            if (bien) vistos[indice / 8] |= bit;
+        }
+    }
+    free(vistos);
+    return bien;
+}
+
+/*revisa que el encabezado de la cache sea valido y corresponda al archivo fuente actual
+E: mapa de la cache, su tamaño, informacion del archivo fuente
+S: 1 si la cache se puede usar, 0 si esta vieja o dañada (ver contenido_valido)
+R: ninguna
+*/
+static int cache_vigente(const unsigned char* mapa, size_t largo, const struct stat* fuente) {
+    if (largo < sizeof(struct encabezado_cache)) return 0;
+
+    const struct encabezado_cache* encabezado = (const struct encabezado_cache*) mapa;
+    if (memcmp(encabezado->magia, MAGIA_CACHE, 8) != 0) return 0;
+    if (encabezado->version != VERSION_CACHE) return 0;
+    if (encabezado->tamano_fuente != (uint64_t) fuente->st_size) return 0;
+    if (encabezado->mtime_segundos != (int64_t) fuente->st_mtim.tv_sec) return 0;
+    if (encabezado->mtime_nanos != (int64_t) fuente->st_mtim.tv_nsec) return 0;
+    if (encabezado->bytes_completos > encabezado->tamano_fuente) return 0;
+    //una ultima línea sin '\n' tiene que estar cargada o no segun el modo (ver solo_lineas_completas)
+    int falta_cola = (encabezado->bytes_completos < encabezado->tamano_fuente);
+    if (solo_lineas_completas() ? encabezado->cola_cargada : (falta_cola && !encabezado->cola_cargada)) return 0;
+
+    uint64_t n = encabezado->total;
+    if (n > INT32_MAX) return 0;
+    if (!seccion_valida(encabezado->pos_anos, n * sizeof(int32_t), sizeof(int32_t), largo)) return 0;
+    if (!seccion_valida(encabezado->pos_palabras, n * sizeof(int32_t), sizeof(int32_t), largo)) return 0;
+    if (!seccion_valida(encabezado->pos_desplazamientos, n * CAMPOS_TEXTO * sizeof(uint64_t), sizeof(uint64_t), largo)) {
+        return 0;
+    }
+    if (!seccion_valida(encabezado->pos_cadenas, encabezado->bytes_cadenas, 1, largo)) return 0;
+    for (int c = 0; c < TOTAL_CRITERIOS; c++) {
+        if (!seccion_valida(encabezado->pos_ordenes[c], n * sizeof(uint32_t), sizeof(uint32_t), largo)) return 0;
+    }
+    return contenido_valido(mapa, encabezado);
+}
+
+/*arma un corpus a partir de la cache ya mapeada: las cadenas y las columnas apuntan dentro del mapa,
+no se parsea nada
+E: mapa de la cache (ya validado) y su tamaño
+S: corpus nuevo, NULL si falla
+R: que cache_vigente haya dado 1
+*/
+static struct corpus* corpus_desde_mapa(void* mapa, size_t largo) {
+    const struct encabezado_cache* encabezado = mapa;
+    const unsigned char* base = mapa;
+    int n = (int) encabezado->total;
+
+    struct corpus* corpus = calloc(1, sizeof(struct corpus));
+    if (corpus == NULL) return NULL;
+    iniciar_arena(&corpus->textos, 0);
+
+    corpus->articulos = malloc((n > 0 ? n : 1) * sizeof(struct articulo));
+    if (corpus->articulos == NULL) {
+        free(corpus);
+        return NULL;
+    }
+
+    const int32_t* anos = (const int32_t*) (base + encabezado->pos_anos);
+    const uint64_t* desplazamientos = (const uint64_t*) (base + encabezado->pos_desplazamientos);
+    char* cadenas = (char*) (base + encabezado->pos_cadenas);
+
+    for (int i = 0; i < n; i++) {
+        char* campos[CAMPOS_TEXTO];
+        for (int c = 0; c < CAMPOS_TEXTO; c++) {
+            uint64_t desplazamiento = desplazamientos[(size_t) i * CAMPOS_TEXTO + c];
+            campos[c] = (desplazamiento == SIN_CADENA) ? NULL : cadenas + desplazamiento;
+        }
+        corpus->articulos[i].nombre_autor = campos[0];
+        corpus->articulos[i].apellido_autor = campos[1];
+        corpus->articulos[i].titulo_articulo = campos[2];
+        corpus->articulos[i].ruta = campos[3];
+        corpus->articulos[i].resumen = campos[4];
+        corpus->articulos[i].ano = anos[i];
+    }
+
+    corpus->total = n;
+    corpus->columnas[COLUMNA_ANO] = (int*) (base + encabezado->pos_anos);
+    corpus->columnas[COLUMNA_PALABRAS_TITULO] = (int*) (base + encabezado->pos_palabras);
+    corpus->columnas_del_mapa = 1;
+    corpus->bytes_fuente = (size_t) encabezado->bytes_completos;
+    corpus->cola_cargada = (int) encabezado->cola_cargada;
+
+    //los ordenamientos ya vienen hechos: una consulta es tomar los primeros N de la permutacion
+    for (int c = 0; c < TOTAL_CRITERIOS && n > 0; c++) {
+        corpus->ordenes[c].indices = (uint32_t*) (base + encabezado->pos_ordenes[c]);
+        corpus->ordenes[c].largo = n;
+        corpus->ordenes[c].del_mapa = 1;
+    }
+    corpus->mapa = mapa;
+    corpus->largo_mapa = largo;
+    return corpus;
+}
+
+/*carga el índice usando la cache binaria si esta al dia; si no existe o el archivo de texto cambio
+(tamaño o fecha), se parsea el texto y se vuelve a escribir la cache
+E: nombre_archivo (ruta al archivo índice de texto)
+S: corpus cargado, NULL si falla
+R: que el archivo exista y tenga el formato correcto
+*/
+struct corpus* cargar_corpus_con_cache(const char* nombre_archivo) {
+    struct stat fuente;
+    if (stat(nombre_archivo, &fuente) != 0) {
+        printf("Error: no se pudo abrir el archivo %s\n", nombre_archivo);
+        return NULL;
+    }
+
+    char* ruta_cache = ruta_cache_binario(nombre_archivo);
+    if (ruta_cache == NULL) return cargar_corpus(nombre_archivo);
+
+    //intentar con la cache
+    int fd = open(ruta_cache, O_RDONLY);
+    if (fd >= 0) {
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size_t largo = (size_t) info.st_size;
+            void* mapa = mmap(NULL, largo, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapa != MAP_FAILED) {
+                if (cache_vigente(mapa, largo, &fuente)) {
+                    struct corpus* corpus = corpus_desde_mapa(mapa, largo);
+                    if (corpus != NULL) {
+                        corpus->inodo_fuente = (uint64_t) fuente.st_ino;
+                        corpus->dispositivo_fuente = (uint64_t) fuente.st_dev;
+                        close(fd);
+                        free(ruta_cache);
+                        sumar_bytes_leidos(largo);
+                        informar("Se cargaron %d articulos desde la cache.\n", corpus->total);
+                        return corpus;
+                    }
+                }
+                munmap(mapa, largo);
+            }
+        }
+        close(fd);
+    }
+
+    //la cache no sirve: parsear el texto y reconstruirla
+    struct corpus* corpus = cargar_corpus(nombre_archivo);
+    if (corpus != NULL) {
+        guardar_cache_binario(corpus, ruta_cache, &fuente);
+    }
+    free(ruta_cache);
+    return corpus;
+}
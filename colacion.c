@@ -0,0 +1,261 @@
+#include "heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//pesos primarios: todo lo que no es letra queda debajo de las letras
+#define PESO_ESPACIO     0x20
+#define PESO_LETRA_A     0x41 // a..n = 0x41..0x4E, ñ = 0x4F, o..z = 0x50..0x5B
+#define PESO_DESCONOCIDO 0x7C // va seguido de los bytes originales del caracter
+#define SEPARADOR_NIVEL  0x02 // separa el nivel primario del desempate por bytes
+#define BYTE_MINIMO      0x03 // ningun byte del desempate baja de aca (0x01 y 0x02 quedan reservados)
+
+//letra base de cada caracter de U+00C0 a U+00FF ('~' = ñ, '*' = no es letra)
+static const char letras_latin1[64] =
+    "AAAAAAACEEEEIIIID~OOOOO*OUUUUY*s"
+    "aaaaaaaceeeeiiiid~ooooo*ouuuuy*y";
+
+/*decodifica un caracter UTF-8
+E: texto (apunta al inicio del caracter), largo (donde guardar cuantos bytes ocupa)
+S: codigo del caracter, o el byte suelto si la secuencia no es valida
+R: que el texto no este vacio
+*/
+static uint32_t leer_utf8(const unsigned char* texto, int* largo) {
+    unsigned char b = texto[0];
+    int bytes = 1;
+    uint32_t codigo = b;
+
+    if (b >= 0xC2 && b <= 0xDF) {
+        bytes = 2;
+        codigo = b & 0x1F;
+    } else if (b >= 0xE0 && b <= 0xEF) {
+        bytes = 3;
+        codigo = b & 0x0F;
+    } else if (b >= 0xF0 && b <= 0xF4) {
+        bytes = 4;
+        codigo = b & 0x07;
+    }
+
+    for (int i = 1; i < bytes; i++) {
+        if ((texto[i] & 0xC0) != 0x80) { //secuencia cortada: se toma el byte solo
+            *largo = 1;
+            return b;
+        }
+        codigo = (codigo << 6) | (texto[i] & 0x3F);
+    }
+    *largo = bytes;
+    return codigo;
+}
+
+/*peso primario de una letra minuscula ascii, con la ñ entre la n y la o
+E: letra entre 'a' y 'z', o '~' para la ñ
+S: peso
+R: ninguna
+*/
+static unsigned char peso_letra(char letra) {
+    if (letra == '~') {
+        return PESO_LETRA_A + ('n' - 'a') + 1;
+    }
+    return PESO_LETRA_A + (letra - 'a') + (letra > 'n' ? 1 : 0);
+}
+
+/*peso primario de un caracter: sin mayusculas ni tildes, la ñ como letra aparte
+E: codigo del caracter
+S: peso (0 si no se conoce y hay que copiar los bytes originales)
+R: ninguna
+*/
+static unsigned char peso_primario(uint32_t codigo) {
+    if (codigo >= 'a' && codigo <= 'z') return peso_letra((char) codigo);
+    if (codigo >= 'A' && codigo <= 'Z') return peso_letra((char) (codigo - 'A' + 'a'));
+    if (codigo < 0x20) return PESO_ESPACIO; //tabs y demas control cuentan como espacio
+    if (codigo < 0x41) return (unsigned char) codigo; //espacio, signos y digitos quedan igual
+    if (codigo < 0x80) return 0x40; //[ \ ] ^ _ ` { | } ~ van junto con @
+
+    if (codigo >= 0xC0 && codigo <= 0xFF) {
+        char letra = letras_latin1[codigo - 0xC0];
+        if (letra == '~') return peso_letra('~');
+        if (letra >= 'A' && letra <= 'Z') return peso_letra((char) (letra - 'A' + 'a'));
+        if (letra >= 'a' && letra <= 'z') return peso_letra(letra);
+        return 0;
+    }
+
+    switch (codigo) {
+        case 0xA0:                      // espacio duro
+            return PESO_ESPACIO;
+        case 0xA1: case 0xBF:           // ¡ ¿
+            return '!';
+        case 0xAB: case 0xBB:           // « »
+        case 0x201C: case 0x201D:       // comillas tipograficas
+            return '"';
+        case 0x2018: case 0x2019:       // comillas simples tipograficas
+            return '\'';
+        case 0x2013: case 0x2014:       // guiones largos
+            return '-';
+        default:
+            return 0;
+    }
+}
+
+/*siguiente termino de busqueda de un texto: letras y digitos seguidos, en minuscula y sin tildes
+(la ñ sigue siendo ñ, una letra aparte como en la llave de colacion: "año" no es "ano"); lo demas separa terminos. los caracteres fuera de latin-1 se copian tal cual.
+un termino mas largo que el destino se corta, igual al indexar y al buscar
+E: texto (donde seguir), destino, capacidad del destino (con el '\0'), largo (donde guardar el largo)
+S: posicion despues del termino, NULL si ya no quedan terminos
+R: que capacidad sea mayor a 4
+*/
+const char* siguiente_termino(const char* texto, char* destino, size_t capacidad, size_t* largo) {
+    const unsigned char* actual = (const unsigned char*) texto;
+    size_t escrito = 0;
+
+    while (*actual != '\0') {
+        int bytes = 1;
+        uint32_t codigo = (*actual < 0x80) ? *actual : leer_utf8(actual, &bytes);
+
+        char letra = 0;
+        int enie = 0;
+        if ((codigo >= 'a' && codigo <= 'z') || (codigo >= '0' && codigo <= '9')) {
+            letra = (char) codigo;
+        } else if (codigo >= 'A' && codigo <= 'Z') {
+            letra = (char) (codigo - 'A' + 'a');
+        } else if (codigo >= 0xC0 && codigo <= 0xFF) {
+            char base = letras_latin1[codigo - 0xC0];
+            if (base == '~') enie = 1;
+            if (base >= 'A' && base <= 'Z') base = (char) (base - 'A' + 'a');
+            if (base >= 'a' && base <= 'z') letra = base;
+        }
+
+        if (enie) {
+            //Ñ y ñ quedan como "ñ" en UTF-8
+            if (escrito + 2 < capacidad) {
+                destino[escrito++] = (char) 0xC3;
+                destino[escrito++] = (char) 0xB1;
+            }
+        } else if (letra != 0) {
+            if (escrito + 1 < capacidad) destino[escrito++] = letra;
+        } else if (codigo >= 0x100 && !(codigo >= 0x2000 && codigo <= 0x2BFF) && !(codigo >= 0x3000 && codigo <= 0x303F)) {
+            //otros alfabetos (no la puntuacion ni los simbolos): se guardan los bytes originales si caben completos
+            if (escrito + (size_t) bytes < capacidad) {
+                memcpy(destino + escrito, actual, bytes);
+                escrito += (size_t) bytes;
+            }
+        } else if (escrito > 0) {
+            break; //fin del termino
+        }
+        actual += bytes;
+    }
+
+    if (escrito == 0) return NULL;
+    destino[escrito] = '\0';
+    *largo = escrito;
+    return (const char*) actual;
+}
+
+/*escribe la llave de colacion de un texto, o solo la mide si destino es NULL
+la llave tiene dos niveles: los pesos primarios (sin mayusculas ni tildes), SEPARADOR_NIVEL
+y los bytes originales para desempatar; ningun byte es 0 asi que sirve con strcmp
+E: texto, destino (NULL para solo contar)
+S: largo de la llave sin contar el '\0'
+R: que el texto no sea NULL
+*/
+static size_t generar_llave(const char* texto, unsigned char* destino) {
+    const unsigned char* actual = (const unsigned char*) texto;
+    size_t largo = 0;
+
+    //nivel primario
+    while (*actual != '\0') {
+        int bytes = 1;
+        uint32_t codigo = leer_utf8(actual, &bytes);
+        unsigned char peso = peso_primario(codigo);
+
+        if (peso != 0) {
+            if (destino != NULL) destino[largo] = peso;
+            largo++;
+        } else {
+            //caracter sin peso conocido: despues de las letras, ordenado por sus bytes
+            if (destino != NULL) {
+                destino[largo] = PESO_DESCONOCIDO;
+                memcpy(destino + largo + 1, actual, bytes);
+            }
+            largo += 1 + bytes;
+        }
+        actual += bytes;
+    }
+
+    //nivel de desempate: los bytes originales (mayusculas antes que minusculas, sin tilde antes que con tilde)
+    if (destino != NULL) destino[largo] = SEPARADOR_NIVEL;
+    largo++;
+    for (actual = (const unsigned char*) texto; *actual != '\0'; actual++) {
+        if (destino != NULL) {
+            destino[largo] = (*actual < BYTE_MINIMO) ? BYTE_MINIMO : *actual;
+        }
+        largo++;
+    }
+
+    if (destino != NULL) destino[largo] = '\0';
+    return largo;
+}
+
+/*escribe la llave de colacion de un texto en un buffer propio, para armar llaves que juntan
+varios campos sin pasar por la arena
+E: texto (NULL se toma como ""), destino (NULL para solo medir)
+S: largo de la llave sin contar el '\0'
+R: que el destino tenga lugar para el largo medido mas el '\0'
+*/
+size_t escribir_llave_colacion(const char* texto, char* destino) {
+    return generar_llave((texto != NULL) ? texto : "", (unsigned char*) destino);
+}
+
+/*calcula una sola vez la llave de colacion de un texto: comparar dos llaves con strcmp da el orden
+en español sin importar mayusculas ni tildes (la ñ va entre la n y la o)
+E: arena donde guardar la llave, texto (NULL se toma como "")
+S: puntero a la llave dentro de la arena, NULL si falla
+R: que la arena haya sido iniciada
+*/
+char* crear_llave_colacion(struct arena* arena, const char* texto) {
+    if (texto == NULL) texto = "";
+
+    size_t largo = generar_llave(texto, NULL);
+    unsigned char* llave = arena_reservar(arena, largo + 1);
+    if (llave == NULL) return NULL;
+    CONTAR(llaves);
+
+    generar_llave(texto, llave);
+    return (char*) llave;
+}
+
+/*igual que crear_llave_colacion pero solo con el nivel primario (sin mayusculas ni tildes y sin
+el desempate por bytes), para buscar prefijos y pedazos de texto: "nash" encuentra a "Násh"
+E: arena, texto (NULL se toma como "")
+S: puntero a la llave primaria dentro de la arena, NULL si falla
+R: que la arena haya sido iniciada
+*/
+char* crear_llave_primaria(struct arena* arena, const char* texto) {
+    char* llave = crear_llave_colacion(arena, texto);
+    if (llave == NULL) return NULL;
+
+    //los bytes originales del nivel primario son >= 0x80, asi que el primer separador es el de nivel
+    char* separador = strchr(llave, SEPARADOR_NIVEL);
+    if (separador != NULL) *separador = '\0';
+    return llave;
+}
+
+/*llena un arreglo con la llave de colacion de cada artículo segun el criterio alfabético
+E: articulos, n, criterio (CRITERIO_TITULO o CRITERIO_RUTA), arena para las llaves, destino (n punteros)
+S: 1 si salio bien, 0 si no
+R: que el criterio sea alfabético
+*/
+int llenar_llaves_alfabeticas(const struct articulo* articulos, int n, enum criterio_orden criterio,
+                              struct arena* arena, const char** destino) {
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+    for (int i = 0; i < n; i++) {
+        const char* texto = (criterio == CRITERIO_TITULO) ? articulos[i].titulo_articulo : articulos[i].ruta;
+        destino[i] = crear_llave_colacion(arena, texto);
+        if (destino[i] == NULL) {
+            fprintf(stderr, "Error: no se pudo calcular la llave de colacion.\n");
+            return 0;
+        }
+    }
+    terminar_fase(FASE_LLAVES, &marca);
+    return 1;
+}
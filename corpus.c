@@ -0,0 +1,168 @@
+#include "heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>  // munmap
+
+/*libera las columnas derivadas (las de la cache mapeada solo se sueltan, el mapa se va con el corpus)
+E: corpus
+S: void
+R: ninguna
+*/
+static void liberar_columnas(struct corpus* corpus) {
+    for (int c = 0; c < TOTAL_COLUMNAS; c++) {
+        if (!corpus->columnas_del_mapa) free(corpus->columnas[c]);
+        corpus->columnas[c] = NULL;
+    }
+    corpus->columnas_del_mapa = 0;
+}
+
+/*libera un corpus completo: el arreglo de artículos y la arena con todas sus cadenas
+(o el mapa de la cache si vino de ahi)
+no hace falta llamar liberar_articulo por cada artículo, las cadenas viven en la arena
+E: puntero al corpus
+S: void
+R: que el corpus haya sido creado con cargar_corpus o cargar_corpus_con_cache
+*/
+void destruir_corpus(struct corpus* corpus) {
+    if (corpus == NULL) return;
+
+    corpus_invalidar_ordenes(corpus);
+    liberar_indices_filtro(corpus);
+    liberar_indice_busqueda(corpus);
+    liberar_columnas(corpus);
+    liberar_arena(&corpus->textos);
+    if (corpus->mapa != NULL) {
+        munmap(corpus->mapa, corpus->largo_mapa);
+    }
+    free(corpus->articulos);
+    free(corpus);
+}
+
+//criterio numerico del que sale cada columna derivada, en el orden de enum columna_derivada
+static const enum criterio_orden criterio_de_columna[TOTAL_COLUMNAS] = {CRITERIO_ANO, CRITERIO_PALABRAS};
+
+/*columna derivada que tiene la llave de un criterio numerico
+E: criterio
+S: la columna, o -1 si el criterio no es numerico
+R: ninguna
+*/
+int columna_de_criterio(enum criterio_orden criterio) {
+    for (int c = 0; c < TOTAL_COLUMNAS; c++) {
+        if (criterio_de_columna[c] == criterio) return c;
+    }
+    return -1;
+}
+
+/*calcula las columnas derivadas de los artículos [desde, total); las columnas crecen hasta total
+y lo de antes de desde se conserva (si venian de la cache mapeada se copian primero)
+se llama con desde = 0 al cargar, y con el total anterior cuando se agregan artículos al final
+E: corpus con los artículos cargados, desde (primer artículo sin columnas)
+S: 1 si salio bien, 0 si no hubo memoria (las columnas quedan en NULL)
+R: que 0 <= desde <= corpus->total
+*/
+int calcular_columnas_derivadas(struct corpus* corpus, int desde) {
+    size_t bytes = (size_t) (corpus->total > 0 ? corpus->total : 1) * sizeof(int);
+    for (int c = 0; c < TOTAL_COLUMNAS; c++) {
+        int* columna;
+        if (corpus->columnas_del_mapa || corpus->columnas[c] == NULL) {
+            columna = malloc(bytes);
+            if (columna != NULL && corpus->columnas[c] != NULL && desde > 0) {
+                memcpy(columna, corpus->columnas[c], (size_t) desde * sizeof(int));
+            }
+        } else {
+            columna = realloc(corpus->columnas[c], bytes);
+        }
+        if (columna == NULL) {
+            fprintf(stderr, "Error: no hay memoria para las columnas del corpus.\n");
+            liberar_columnas(corpus);
+            return 0;
+        }
+        corpus->columnas[c] = columna;
+    }
+    corpus->columnas_del_mapa = 0;
+
+    for (int c = 0; c < TOTAL_COLUMNAS; c++) {
+        llenar_llaves_numericas(corpus->articulos + desde, corpus->total - desde, criterio_de_columna[c],
+                                corpus->columnas[c] + desde);
+    }
+    return 1;
+}
+
+/*ordena solo los artículos [desde, total) del corpus (todos con desde = 0, o un lote recien agregado)
+E: corpus, criterio, desde, k (cuantos indices del rango se necesitan)
+S: arreglo nuevo con k indices del corpus en orden (hay que liberarlo), NULL si falla
+R: que 1 <= k <= corpus->total - desde
+*/
+uint32_t* corpus_ordenar_rango(struct corpus* corpus, enum criterio_orden criterio, int desde, int k) {
+    int n = corpus->total - desde;
+    uint32_t* indices;
+    int columna = columna_de_criterio(criterio);
+    if (columna >= 0 && corpus->columnas[columna] != NULL) {
+        //la llave ya esta en su columna, no hay que volver a leer los artículos
+        indices = ordenar_llaves_numericas_k(corpus->columnas[columna] + desde, n, k);
+    } else {
+        indices = ordenar_paralelo_top_k(corpus->articulos + desde, n, criterio, k);
+    }
+    if (indices == NULL) return NULL;
+
+    //los indices salen relativos al rango
+    for (int i = 0; desde > 0 && i < k; i++) {
+        indices[i] += (uint32_t) desde;
+    }
+    return indices;
+}
+
+/*devuelve los primeros k indices ordenados por el criterio; el resultado se guarda en el corpus
+y se reutiliza mientras alcance, asi repetir la misma consulta no vuelve a ordenar
+E: corpus, criterio, k (cuantos indices se necesitan)
+S: arreglo con al menos k indices en orden (es del corpus, no se libera), NULL si falla
+R: que 1 <= k <= corpus->total
+*/
+const uint32_t* corpus_obtener_orden(struct corpus* corpus, enum criterio_orden criterio, int k) {
+    if (corpus == NULL || criterio < 0 || criterio >= TOTAL_CRITERIOS) return NULL;
+
+    struct orden_guardado* guardado = &corpus->ordenes[criterio];
+    if (guardado->indices != NULL && guardado->largo >= k) {
+        return guardado->indices; //ya estaba calculado
+    }
+
+    uint32_t* indices = corpus_ordenar_rango(corpus, criterio, 0, k);
+    if (indices == NULL) return NULL;
+
+    if (!guardado->del_mapa) {
+        free(guardado->indices);
+    }
+    guardado->indices = indices;
+    guardado->largo = k;
+    guardado->del_mapa = 0;
+    return indices;
+}
+
+/*borra el ordenamiento guardado de un criterio, se recalcula la proxima vez que se pida
+E: corpus, criterio
+S: void
+R: que el corpus exista
+*/
+void corpus_invalidar_orden(struct corpus* corpus, enum criterio_orden criterio) {
+    struct orden_guardado* guardado = &corpus->ordenes[criterio];
+    if (!guardado->del_mapa) {
+        free(guardado->indices);
+    }
+    guardado->indices = NULL;
+    guardado->largo = 0;
+    guardado->del_mapa = 0;
+}
+
+/*borra todos los ordenamientos guardados, se recalculan la proxima vez que se pidan
+E: corpus
+S: void
+R: que el corpus exista
+*/
+void corpus_invalidar_ordenes(struct corpus* corpus) {
+    if (corpus == NULL) return;
+
+    for (int c = 0; c < TOTAL_CRITERIOS; c++) {
+        corpus_invalidar_orden(corpus, (enum criterio_orden) c);
+    }
+}
@@ -0,0 +1,311 @@
+#include "heap.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ESCANER_X86 1
+#endif
+
+//cantidad de bytes que se revisan de una vez (una mascara de 32 bits)
+#define BLOQUE_ESCANER 32
+
+/*mascara de delimitadores ('|', '\n', '\r') de un bloque, un bit por byte, sin SIMD;
+tambien sirve para el pedazo final de menos de BLOQUE_ESCANER bytes
+E: inicio del bloque, cantidad de bytes (hasta BLOQUE_ESCANER)
+S: bit i prendido si el byte i es delimitador
+R: que se puedan leer esos bytes
+*/
+static inline uint32_t mascara_escalar(const char* p, size_t largo) {
+    uint32_t mascara = 0;
+    for (size_t i = 0; i < largo; i++) {
+        char c = p[i];
+        if (c == '|' || c == '\n' || c == '\r') {
+            mascara |= (uint32_t) 1 << i;
+        }
+    }
+    return mascara;
+}
+
+#ifdef ESCANER_X86
+//SSE2 esta en todos los x86-64: dos comparaciones de 16 bytes por bloque
+__attribute__((target("sse2")))
+static inline uint32_t mascara_sse2(const char* p) {
+    const __m128i barra = _mm_set1_epi8('|');
+    const __m128i salto = _mm_set1_epi8('\n');
+    const __m128i retorno = _mm_set1_epi8('\r');
+
+    __m128i bajo = _mm_loadu_si128((const __m128i*) p);
+    __m128i alto = _mm_loadu_si128((const __m128i*) (p + 16));
+    __m128i en_bajo = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bajo, barra), _mm_cmpeq_epi8(bajo, salto)),
+                                   _mm_cmpeq_epi8(bajo, retorno));
+    __m128i en_alto = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(alto, barra), _mm_cmpeq_epi8(alto, salto)),
+                                   _mm_cmpeq_epi8(alto, retorno));
+    return (uint32_t) _mm_movemask_epi8(en_bajo) | ((uint32_t) _mm_movemask_epi8(en_alto) << 16);
+}
+
+//AVX2: el bloque entero en una sola comparacion de 32 bytes
+__attribute__((target("avx2")))
+static inline uint32_t mascara_avx2(const char* p) {
+    const __m256i barra = _mm256_set1_epi8('|');
+    const __m256i salto = _mm256_set1_epi8('\n');
+    const __m256i retorno = _mm256_set1_epi8('\r');
+
+    __m256i bloque = _mm256_loadu_si256((const __m256i*) p);
+    __m256i iguales = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bloque, barra),
+                                                      _mm256_cmpeq_epi8(bloque, salto)),
+                                      _mm256_cmpeq_epi8(bloque, retorno));
+    return (uint32_t) _mm256_movemask_epi8(iguales);
+}
+#endif
+
+static inline uint32_t mascara_bloque_escalar(const char* p) {
+    return mascara_escalar(p, BLOQUE_ESCANER);
+}
+
+/*anota un campo [inicio, fin) si todavia cabe
+E: campos, inicio y fin del campo
+S: void
+R: ninguna
+*/
+static inline void anotar_campo(struct campos_registro* campos, const char* inicio, const char* fin) {
+    if (campos->cantidad < CAMPOS_REGISTRO) {
+        campos->inicio[campos->cantidad] = inicio;
+        campos->largo[campos->cantidad] = (size_t) (fin - inicio);
+    }
+    campos->cantidad++;
+}
+
+/*recorre un registro bloque por bloque: cada bloque da una mascara con todos sus delimitadores
+y se visitan solo los bits prendidos, asi un bloque con varios campos cortos se carga una vez.
+la funcion de mascara es una constante en cada version, el compilador la mete en linea
+E: inicio del registro, fin de los datos, campos (salida), funcion que calcula la mascara de un bloque
+S: inicio del registro siguiente (despues del '\n'), o fin
+R: ninguna
+*/
+static inline __attribute__((always_inline))
+const char* separar_generico(const char* inicio, const char* fin, struct campos_registro* campos,
+                             uint32_t (*mascara_bloque)(const char*)) {
+    const char* campo = inicio;
+    const char* p = inicio;
+    campos->cantidad = 0;
+
+    while (p < fin) {
+        size_t disponible = (size_t) (fin - p);
+        size_t largo = (disponible >= BLOQUE_ESCANER) ? BLOQUE_ESCANER : disponible;
+        uint32_t mascara = (largo == BLOQUE_ESCANER) ? mascara_bloque(p) : mascara_escalar(p, largo);
+
+        while (mascara != 0) {
+            const char* q = p + __builtin_ctz(mascara);
+            mascara &= mascara - 1;
+
+            if (*q == '|') {
+                anotar_campo(campos, campo, q);
+                campo = q + 1;
+            } else if (*q == '\n') {
+                if (q > campo) anotar_campo(campos, campo, q);
+                return q + 1;
+            } else if (q + 1 == fin || q[1] == '\n') {
+                //'\r' de windows justo antes del fin de línea; un '\r' suelto queda dentro del campo
+                if (q > campo) anotar_campo(campos, campo, q);
+                return (q + 1 == fin) ? fin : q + 2;
+            }
+        }
+        p += largo;
+    }
+
+    //ultima línea sin '\n': el ultimo campo solo cuenta si no esta vacio (igual que con "|" al final)
+    if (fin > campo) anotar_campo(campos, campo, fin);
+    return fin;
+}
+
+static const char* separar_escalar(const char* inicio, const char* fin, struct campos_registro* campos) {
+    return separar_generico(inicio, fin, campos, mascara_bloque_escalar);
+}
+
+#ifdef ESCANER_X86
+__attribute__((target("sse2")))
+static const char* separar_sse2(const char* inicio, const char* fin, struct campos_registro* campos) {
+    return separar_generico(inicio, fin, campos, mascara_sse2);
+}
+
+__attribute__((target("avx2")))
+static const char* separar_avx2(const char* inicio, const char* fin, struct campos_registro* campos) {
+    return separar_generico(inicio, fin, campos, mascara_avx2);
+}
+#endif
+
+/*mascara de espacios (' ', '\n', '\t', los mismos que separan palabras) sin SIMD;
+los bytes de UTF-8 (>= 0x80) nunca son espacio, asi una letra con tilde queda dentro de su palabra
+E: inicio del bloque, cantidad de bytes (hasta BLOQUE_ESCANER)
+S: bit i prendido si el byte i es espacio
+R: que se puedan leer esos bytes
+*/
+static inline uint32_t espacios_escalar(const char* p, size_t largo) {
+    uint32_t mascara = 0;
+    for (size_t i = 0; i < largo; i++) {
+        char c = p[i];
+        if (c == ' ' || c == '\n' || c == '\t') {
+            mascara |= (uint32_t) 1 << i;
+        }
+    }
+    return mascara;
+}
+
+static inline uint32_t espacios_bloque_escalar(const char* p) {
+    return espacios_escalar(p, BLOQUE_ESCANER);
+}
+
+#ifdef ESCANER_X86
+__attribute__((target("sse2")))
+static inline uint32_t espacios_sse2(const char* p) {
+    const __m128i espacio = _mm_set1_epi8(' ');
+    const __m128i salto = _mm_set1_epi8('\n');
+    const __m128i tabulador = _mm_set1_epi8('\t');
+
+    __m128i bajo = _mm_loadu_si128((const __m128i*) p);
+    __m128i alto = _mm_loadu_si128((const __m128i*) (p + 16));
+    __m128i en_bajo = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bajo, espacio), _mm_cmpeq_epi8(bajo, salto)),
+                                   _mm_cmpeq_epi8(bajo, tabulador));
+    __m128i en_alto = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(alto, espacio), _mm_cmpeq_epi8(alto, salto)),
+                                   _mm_cmpeq_epi8(alto, tabulador));
+    return (uint32_t) _mm_movemask_epi8(en_bajo) | ((uint32_t) _mm_movemask_epi8(en_alto) << 16);
+}
+
+__attribute__((target("avx2")))
+static inline uint32_t espacios_avx2(const char* p) {
+    const __m256i espacio = _mm256_set1_epi8(' ');
+    const __m256i salto = _mm256_set1_epi8('\n');
+    const __m256i tabulador = _mm256_set1_epi8('\t');
+
+    __m256i bloque = _mm256_loadu_si256((const __m256i*) p);
+    __m256i iguales = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bloque, espacio),
+                                                      _mm256_cmpeq_epi8(bloque, salto)),
+                                      _mm256_cmpeq_epi8(bloque, tabulador));
+    return (uint32_t) _mm256_movemask_epi8(iguales);
+}
+#endif
+
+/*cuenta palabras contando las transiciones de espacio a no espacio: un byte empieza palabra
+si no es espacio y el anterior si lo es (antes del texto cuenta como espacio), y eso para
+32 bytes a la vez es ~espacios & (espacios << 1 | acarreo), sin un salto por byte
+E: texto, largo en bytes, funcion que calcula la mascara de espacios de un bloque
+S: cantidad de palabras
+R: que se puedan leer largo bytes
+*/
+static inline __attribute__((always_inline))
+int contar_generico(const char* texto, size_t largo, uint32_t (*espacios_bloque)(const char*)) {
+    int palabras = 0;
+    uint32_t acarreo = 1; //el byte anterior al bloque era espacio
+
+    size_t i = 0;
+    for (; i + BLOQUE_ESCANER <= largo; i += BLOQUE_ESCANER) {
+        uint32_t espacios = espacios_bloque(texto + i);
+        palabras += __builtin_popcount(~espacios & ((espacios << 1) | acarreo));
+        acarreo = espacios >> (BLOQUE_ESCANER - 1);
+    }
+    if (i < largo) {
+        size_t resto = largo - i;
+        uint32_t validos = ((uint32_t) 1 << resto) - 1; //resto < BLOQUE_ESCANER
+        uint32_t espacios = espacios_escalar(texto + i, resto);
+        palabras += __builtin_popcount(~espacios & ((espacios << 1) | acarreo) & validos);
+    }
+    return palabras;
+}
+
+static int contar_escalar(const char* texto, size_t largo) {
+    return contar_generico(texto, largo, espacios_bloque_escalar);
+}
+
+#ifdef ESCANER_X86
+__attribute__((target("sse2")))
+static int contar_sse2(const char* texto, size_t largo) {
+    return contar_generico(texto, largo, espacios_sse2);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int contar_avx2(const char* texto, size_t largo) {
+    return contar_generico(texto, largo, espacios_avx2);
+}
+#endif
+
+//version que usa separar_registro, se elige una sola vez al arrancar el programa
+static const char* (*separar_elegido)(const char*, const char*, struct campos_registro*) = separar_escalar;
+static int (*contar_elegido)(const char*, size_t) = contar_escalar;
+static const char* nombre_elegido = "escalar";
+
+/*elige la version del escaner segun lo que soporta el procesador (corre antes de main,
+asi ningun hilo ve el puntero cambiando)
+E: ninguna
+S: void
+R: ninguna
+*/
+__attribute__((constructor))
+static void elegir_escaner(void) {
+#ifdef ESCANER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        separar_elegido = separar_avx2;
+        contar_elegido = contar_avx2;
+        nombre_elegido = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        separar_elegido = separar_sse2;
+        contar_elegido = contar_sse2;
+        nombre_elegido = "sse2";
+    }
+#endif
+}
+
+/*separa un registro nombre|apellido|titulo|ruta|año|resumen| en sus campos, sin copiar nada:
+cada campo es un inicio y un largo dentro de los datos, y los campos vacios ("||") cuentan
+E: inicio del registro, fin de los datos (puede haber mas lineas despues), campos (salida)
+S: inicio del registro siguiente; campos->cantidad es 0 si la línea estaba vacia
+R: que inicio <= fin
+*/
+const char* separar_registro(const char* inicio, const char* fin, struct campos_registro* campos) {
+    return separar_elegido(inicio, fin, campos);
+}
+
+/*cuenta las palabras de un texto (separadas por ' ', '\n' o '\t'), igual que contar_palabras
+pero con el largo ya conocido y 32 bytes por paso
+E: texto, largo en bytes
+S: cantidad de palabras
+R: que se puedan leer largo bytes
+*/
+int contar_palabras_largo(const char* texto, size_t largo) {
+    return contar_elegido(texto, largo);
+}
+
+/*cambia la version del escaner (para comparar en el benchmark)
+E: nombre ("avx2", "sse2" o "escalar")
+S: 1 si esa version existe y el procesador la soporta, 0 si no
+R: no llamarla mientras otros hilos esten parseando
+*/
+int configurar_escaner(const char* nombre) {
+    if (strcmp(nombre, "escalar") == 0) {
+        separar_elegido = separar_escalar;
+        contar_elegido = contar_escalar;
+        nombre_elegido = "escalar";
+        return 1;
+    }
+#ifdef ESCANER_X86
+    if (strcmp(nombre, "sse2") == 0 && __builtin_cpu_supports("sse2")) {
+        separar_elegido = separar_sse2;
+        contar_elegido = contar_sse2;
+        nombre_elegido = "sse2";
+        return 1;
+    }
+    if (strcmp(nombre, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        separar_elegido = separar_avx2;
+        contar_elegido = contar_avx2;
+        nombre_elegido = "avx2";
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+const char* escaner_actual(void) {
+    return nombre_elegido;
+}
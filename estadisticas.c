@@ -0,0 +1,171 @@
+#include "heap.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <time.h>
+
+//nombres de las fases en la linea de estadisticas, en el orden de enum fase
+static const char* nombres_fases[TOTAL_FASES] = {
+    "carga", "parseo", "llaves", "indices", "construccion", "extraccion", "orden_hilos", "impresion"
+};
+
+//cuantas fases pueden estar abiertas una dentro de otra en el mismo hilo
+#define PROFUNDIDAD_MAXIMA 32
+
+//con --stats se toman los tiempos; si no, iniciar_fase y terminar_fase no hacen nada
+static int estadisticas_encendidas = 0;
+
+//acumulados de todo el programa (los hilos suman aca con el candado); el tiempo de pared solo lo
+//suma el hilo que prendio las estadisticas, asi no se cuenta una vez por hilo
+static pthread_mutex_t candado = PTHREAD_MUTEX_INITIALIZER;
+static double pared_fases[TOTAL_FASES];
+static double cpu_fases[TOTAL_FASES];
+static pthread_t coordinador;
+static double inicio_pared = 0;
+
+//fases abiertas del hilo: lo que tardaron las fases de adentro se le descuenta a la de afuera,
+//asi cada segundo queda en una sola fase y las fases suman a lo sumo el total
+static _Thread_local int profundidad = 0;
+static _Thread_local double pared_anidada[PROFUNDIDAD_MAXIMA];
+static _Thread_local double cpu_anidado[PROFUNDIDAD_MAXIMA];
+static _Atomic unsigned long long bytes_leidos = 0; //atomico: se suma seguido (por linea en el ordenamiento externo)
+
+#ifdef ESTADISTICAS
+static struct contadores_heap contadores_totales;
+_Thread_local struct contadores_heap contadores_hilo;
+#endif
+
+static double segundos(clockid_t reloj) {
+    struct timespec t;
+    clock_gettime(reloj, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/*prende o apaga la toma de tiempos por fase
+E: activas (1 o 0)
+S: void
+R: ninguna
+*/
+void configurar_estadisticas(int activas) {
+    estadisticas_encendidas = activas;
+    if (activas) {
+        coordinador = pthread_self();
+        inicio_pared = segundos(CLOCK_MONOTONIC);
+    }
+}
+
+int estadisticas_activas(void) {
+    return estadisticas_encendidas;
+}
+
+/*marca el inicio de una fase; el tiempo de CPU es el del hilo que la llama
+E: marca donde guardar el inicio
+S: void
+R: que la marca no sea NULL
+*/
+void iniciar_fase(struct marca_tiempo* marca) {
+    if (!estadisticas_encendidas) return;
+    marca->nivel = -1;
+    if (profundidad < PROFUNDIDAD_MAXIMA) {
+        marca->nivel = profundidad++;
+        pared_anidada[marca->nivel] = 0;
+        cpu_anidado[marca->nivel] = 0;
+    }
+    marca->pared = segundos(CLOCK_MONOTONIC);
+    marca->cpu = segundos(CLOCK_THREAD_CPUTIME_ID);
+}
+
+/*suma el tiempo desde la marca a la fase, sin lo que tardaron las fases que se abrieron adentro
+(eso ya quedo en ellas); el tiempo de CPU se suma de todos los hilos, el de pared solo del hilo
+coordinador (el de los hilos de trabajo ya esta dentro de la fase que los espera)
+E: fase, marca de iniciar_fase
+S: void
+R: que la marca venga de iniciar_fase
+*/
+void terminar_fase(enum fase fase, const struct marca_tiempo* marca) {
+    if (!estadisticas_encendidas) return;
+    double pared = segundos(CLOCK_MONOTONIC) - marca->pared;
+    double cpu = segundos(CLOCK_THREAD_CPUTIME_ID) - marca->cpu;
+
+    double pared_propia = pared;
+    double cpu_propio = cpu;
+    if (marca->nivel >= 0) {
+        //si alguna fase de adentro no se cerro (un return por error) se descarta aca
+        profundidad = marca->nivel;
+        pared_propia -= pared_anidada[marca->nivel];
+        cpu_propio -= cpu_anidado[marca->nivel];
+        if (marca->nivel > 0) {
+            pared_anidada[marca->nivel - 1] += pared;
+            cpu_anidado[marca->nivel - 1] += cpu;
+        }
+    }
+
+    pthread_mutex_lock(&candado);
+    if (pthread_equal(pthread_self(), coordinador)) {
+        pared_fases[fase] += pared_propia;
+    }
+    cpu_fases[fase] += cpu_propio;
+    pthread_mutex_unlock(&candado);
+}
+
+/*anota bytes leidos de disco (archivo índice, cache o corridas)
+E: bytes
+S: void
+R: ninguna
+*/
+void sumar_bytes_leidos(size_t bytes) {
+    atomic_fetch_add_explicit(&bytes_leidos, bytes, memory_order_relaxed);
+}
+
+/*pasa los contadores del hilo actual a los totales y los deja en cero;
+cada hilo de trabajo lo llama antes de terminar
+E: ninguna
+S: void
+R: ninguna
+*/
+void acumular_contadores_hilo(void) {
+#ifdef ESTADISTICAS
+    pthread_mutex_lock(&candado);
+    contadores_totales.comparaciones += contadores_hilo.comparaciones;
+    contadores_totales.intercambios += contadores_hilo.intercambios;
+    contadores_totales.realocaciones += contadores_hilo.realocaciones;
+    contadores_totales.llaves += contadores_hilo.llaves;
+    pthread_mutex_unlock(&candado);
+    contadores_hilo = (struct contadores_heap) {0, 0, 0, 0};
+#endif
+}
+
+/*escribe en stderr una sola linea clave=valor con los tiempos, los contadores y la memoria:
+pared_total es desde que se prendieron las estadisticas, cada pared_FASE es la parte de ese total que
+se paso en la fase (sin las fases de adentro) y pared_otros lo que no cayo en ninguna; cpu_FASE suma
+todos los hilos (los contadores de los heaps solo salen si se compilo con -DESTADISTICAS)
+E: ninguna
+S: void
+R: ninguna
+*/
+void reportar_estadisticas(void) {
+    acumular_contadores_hilo();
+
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+
+    double total = segundos(CLOCK_MONOTONIC) - inicio_pared;
+    pthread_mutex_lock(&candado);
+    double en_fases = 0;
+    fprintf(stderr, "estadisticas pared_total=%.6f", total);
+    for (int f = 0; f < TOTAL_FASES; f++) {
+        fprintf(stderr, " pared_%s=%.6f cpu_%s=%.6f", nombres_fases[f], pared_fases[f], nombres_fases[f], cpu_fases[f]);
+        en_fases += pared_fases[f];
+    }
+    fprintf(stderr, " pared_otros=%.6f", (total > en_fases) ? total - en_fases : 0.0);
+#ifdef ESTADISTICAS
+    fprintf(stderr, " comparaciones=%llu intercambios=%llu realocaciones=%llu llaves=%llu",
+            (unsigned long long) contadores_totales.comparaciones,
+            (unsigned long long) contadores_totales.intercambios,
+            (unsigned long long) contadores_totales.realocaciones,
+            (unsigned long long) contadores_totales.llaves);
+#endif
+    fprintf(stderr, " bytes_leidos=%llu rss_max_kb=%ld\n", atomic_load(&bytes_leidos), uso.ru_maxrss);
+    pthread_mutex_unlock(&candado);
+}
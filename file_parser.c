@@ -1,7 +1,12 @@
 #include "heap.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
 
 /*lee una línea del archivo y la parsea en un artículo
 formato esperado: nombre|apellido|titulo|ruta|año|resumen|
@@ -10,55 +15,21 @@ S: estructura articulo con los datos parseados
 R: que la linea tenga el formato correcto con delimitador "|"
 */
 static struct articulo parsear_linea(char* linea) {
-    //remover salto de línea si existe
-    size_t len = strlen(linea);
-    if (len > 0 && linea[len-1] == '\n') {
-        linea[len-1] = '\0';
-    }
-    if (len > 1 && linea[len-2] == '\r') {
-        linea[len-2] = '\0';
-    }
-    
-    //crear artículo usando la función de heap.c
-    char* nombre = NULL;
-    char* apellido = NULL;
-    char* titulo = NULL;
-    char* ruta = NULL;
-    int ano = 0;
-    char* resumen = NULL;
-    
-    //parsear usando strtok con delimitador "|"
-    char* token;
-    int campo = 0;
-    
-    token = strtok(linea, "|");
-    while (token != NULL && campo < 6) {
-        switch(campo) {
-            case 0: // Nombre autor
-                nombre = token;
-                break;
-            case 1: // Apellido autor
-                apellido = token;
-                break;
-            case 2: // Título
-                titulo = token;
-                break;
-            case 3: // Ruta
-                ruta = token;
-                break;
-            case 4: // Año
-                ano = atoi(token);
-                break;
-            case 5: // Resumen
-                resumen = token;
-                break;
-        }
-        campo++;
-        token = strtok(NULL, "|");
-    }
-    
-    //crear y retornar el artículo
-    return crear_articulo(nombre, apellido, titulo, ruta, ano, resumen);
+    //el escaner respeta los campos vacios (strtok los juntaba y corria las columnas)
+    //y corta solo en el salto de línea
+    return parsear_registro(NULL, linea, linea + strlen(linea));
+}
+
+/*dice si una línea leida con getline no tiene nada antes del fin de línea ("\n" o "\r\n"), las mismas
+que descarta el escaner de cargar_articulos_mmap
+E: linea, largo leido
+S: 1 si esta vacia, 0 si no
+R: que la linea no sea NULL
+*/
+static int linea_vacia(const char* linea, ssize_t largo) {
+    if (largo > 0 && linea[largo - 1] == '\n') largo--;
+    if (largo > 0 && linea[largo - 1] == '\r') largo--;
+    return largo == 0;
 }
 
 /*carga todos los artículos desde el archivo índice
@@ -73,18 +44,23 @@ struct articulo* cargar_articulos(const char* nombre_archivo, int* total) {
         return NULL;
     }
     
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+
     //contar líneas primero
     int num_articulos = 0;
-    char buffer[4096]; // Buffer grande para líneas largas (resúmenes extensos)
+    char* buffer = NULL; // getline lo agranda: los resúmenes largos no se cortan en dos artículos
+    size_t capacidad = 0;
+    ssize_t largo;
     
-    while (fgets(buffer, sizeof(buffer), archivo) != NULL) {
+    while ((largo = getline(&buffer, &capacidad, archivo)) >= 0) {
         //ignorar líneas vacías
-        if (strlen(buffer) > 1) {
+        if (!linea_vacia(buffer, largo)) {
             num_articulos++;
         }
     }
     
-    printf("Se encontraron %d articulos en el archivo.\n", num_articulos);
+    informar("Se encontraron %d articulos en el archivo.\n", num_articulos);
     
     //volver al inicio del archivo
     rewind(archivo);
@@ -93,23 +69,416 @@ struct articulo* cargar_articulos(const char* nombre_archivo, int* total) {
     struct articulo* articulos = (struct articulo*) calloc(num_articulos, sizeof(struct articulo));
     if (articulos == NULL) {
         printf("Error: no se pudo asignar memoria para %d articulos\n", num_articulos);
+        free(buffer);
         fclose(archivo);
         return NULL;
     }
     
     //leer y parsear cada línea
     int i = 0;
-    while (fgets(buffer, sizeof(buffer), archivo) != NULL && i < num_articulos) {
+    size_t leidos = 0;
+    while (i < num_articulos && (largo = getline(&buffer, &capacidad, archivo)) >= 0) {
+        leidos += (size_t) largo;
         //ignorar líneas vacías
-        if (strlen(buffer) > 1) {
+        if (!linea_vacia(buffer, largo)) {
             articulos[i] = parsear_linea(buffer);
             i++;
         }
     }
     
+    free(buffer);
     fclose(archivo);
     *total = num_articulos;
+    sumar_bytes_leidos(leidos);
+    terminar_fase(FASE_PARSEO, &marca);
     
-    printf("Se cargaron %d articulos exitosamente.\n", num_articulos);
+    informar("Se cargaron %d articulos exitosamente.\n", num_articulos);
+    return articulos;
+}
+
+/*copia un campo que no termina en '\0' (viene del archivo mapeado) a memoria nueva
+E: arena donde copiar (NULL para usar malloc), inicio del campo y su largo en bytes
+S: puntero a la nueva cadena terminada en '\0', NULL si falla
+R: que inicio no sea NULL
+*/
+static char* copiar_campo(struct arena* arena, const char* inicio, size_t largo) {
+    if (inicio == NULL) return NULL;
+    if (arena != NULL) {
+        return arena_copiar(arena, inicio, largo);
+    }
+    char* copia = malloc(largo + 1);
+    if (copia != NULL) {
+        memcpy(copia, inicio, largo);
+        copia[largo] = '\0';
+    }
+    return copia;
+}
+
+/*convierte el campo del año a entero sin necesitar el '\0' final (igual que atoi)
+E: inicio del campo y su largo
+S: el año como entero, 0 si no hay digitos
+R: ninguna
+*/
+static int convertir_ano(const char* inicio, size_t largo) {
+    size_t i = 0;
+    int signo = 1;
+    int valor = 0;
+
+    while (i < largo && (inicio[i] == ' ' || inicio[i] == '\t')) i++;
+    if (i < largo && (inicio[i] == '-' || inicio[i] == '+')) {
+        if (inicio[i] == '-') signo = -1;
+        i++;
+    }
+    while (i < largo && inicio[i] >= '0' && inicio[i] <= '9') {
+        valor = valor * 10 + (inicio[i] - '0');
+        i++;
+    }
+    return signo * valor;
+}
+
+/*copia los campos ya separados de un registro a un artículo; los que faltan quedan en NULL
+E: arena donde copiar las cadenas (NULL para malloc), campos de separar_registro
+S: estructura articulo con los datos copiados en memoria
+R: ninguna
+*/
+static struct articulo armar_articulo(struct arena* arena, const struct campos_registro* campos) {
+    const char* inicio[CAMPOS_REGISTRO] = {NULL, NULL, NULL, NULL, NULL, NULL};
+    size_t largo[CAMPOS_REGISTRO] = {0, 0, 0, 0, 0, 0};
+    for (int c = 0; c < campos->cantidad && c < CAMPOS_REGISTRO; c++) {
+        inicio[c] = campos->inicio[c];
+        largo[c] = campos->largo[c];
+    }
+
+    struct articulo art;
+    art.nombre_autor = copiar_campo(arena, inicio[0], largo[0]);
+    art.apellido_autor = copiar_campo(arena, inicio[1], largo[1]);
+    art.titulo_articulo = copiar_campo(arena, inicio[2], largo[2]);
+    art.ruta = copiar_campo(arena, inicio[3], largo[3]);
+    art.ano = (inicio[4] != NULL) ? convertir_ano(inicio[4], largo[4]) : 0;
+    art.resumen = copiar_campo(arena, inicio[5], largo[5]);
+    return art;
+}
+
+/*parsea un registro del archivo mapeado sin copiarlo antes a un buffer
+formato esperado: nombre|apellido|titulo|ruta|año|resumen|
+E: arena donde copiar las cadenas (NULL para malloc), inicio y fin del registro (fin apunta al '\n' o al final del archivo)
+S: estructura articulo con los datos copiados en memoria
+R: que el registro ya venga sin el salto de línea
+*/
+struct articulo parsear_registro(struct arena* arena, const char* inicio, const char* fin) {
+    struct campos_registro campos;
+    separar_registro(inicio, fin, &campos);
+    return armar_articulo(arena, &campos);
+}
+
+//debajo de esta cantidad de bytes por hilo no vale la pena parsear en paralelo
+#define MINIMO_BYTES_POR_HILO (1 << 20)
+
+//pedazo del archivo mapeado [inicio, fin) que parsea un hilo; los cortes caen justo despues de un '\n'
+struct trabajo_parseo {
+    const char* inicio;
+    const char* fin;
+    struct arena* arena;        // donde van las cadenas (NULL para malloc)
+    struct arena arena_propia;  // la de cada hilo cuando hay varios, despues se pasa a la del corpus
+    struct articulo* articulos;
+    int cantidad;
+};
+
+/*libera los artículos de un pedazo (las cadenas solo si se pidieron con malloc)
+E: trabajo
+S: void
+R: ninguna
+*/
+static void liberar_pedazo(struct trabajo_parseo* trabajo) {
+    for (int i = 0; i < trabajo->cantidad && trabajo->arena == NULL; i++) {
+        liberar_articulo(&trabajo->articulos[i]);
+    }
+    free(trabajo->articulos);
+    trabajo->articulos = NULL;
+    trabajo->cantidad = 0;
+}
+
+/*parsea todas las lineas de un pedazo; el arreglo crece mientras se lee
+E: puntero a su struct trabajo_parseo
+S: NULL (si falla deja articulos en NULL)
+R: que el pedazo empiece al inicio de una linea
+*/
+static void* parsear_pedazo(void* arg) {
+    struct trabajo_parseo* trabajo = arg;
+    int capacidad = 64;
+    trabajo->cantidad = 0;
+    trabajo->articulos = malloc(capacidad * sizeof(struct articulo));
+    if (trabajo->articulos == NULL) {
+        printf("Error: no se pudo asignar memoria para los articulos\n");
+        return NULL;
+    }
+
+    //en un hilo de trabajo esto suma su tiempo de CPU (el de pared lo cuenta quien lo espera)
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+
+    //el escaner encuentra los '|' y el fin de línea en la misma pasada
+    struct campos_registro campos;
+    const char* actual = trabajo->inicio;
+    while (actual < trabajo->fin) {
+        actual = separar_registro(actual, trabajo->fin, &campos);
+
+        //ignorar líneas vacías
+        if (campos.cantidad > 0) {
+            //duplicar la capacidad si ya no hay campo
+            if (trabajo->cantidad == capacidad) {
+                int nueva_capacidad = capacidad * 2;
+                struct articulo* nuevo = realloc(trabajo->articulos, nueva_capacidad * sizeof(struct articulo));
+                if (nuevo == NULL) {
+                    printf("Error: no se pudo redimensionar el arreglo de articulos\n");
+                    liberar_pedazo(trabajo);
+                    return NULL;
+                }
+                trabajo->articulos = nuevo;
+                capacidad = nueva_capacidad;
+            }
+            trabajo->articulos[trabajo->cantidad] = armar_articulo(trabajo->arena, &campos);
+            trabajo->cantidad++;
+        }
+    }
+    terminar_fase(FASE_PARSEO, &marca);
+    return NULL;
+}
+
+//1 si al cargar el corpus se deja afuera una ultima línea sin '\n' (ver configurar_solo_lineas_completas)
+static int lineas_completas = 0;
+
+/*decide que hace cargar_corpus con una ultima línea que no termina en '\n': normalmente se carga
+igual, pero si el índice se va a vigilar puede ser un registro que todavia se esta escribiendo, y
+entonces se deja para la recarga incremental (que la lee cuando llega su '\n')
+E: 1 para cargar solo lineas completas, 0 para cargar todo
+S: void
+R: llamarlo antes de cargar el corpus
+*/
+void configurar_solo_lineas_completas(int activas) {
+    lineas_completas = activas ? 1 : 0;
+}
+
+int solo_lineas_completas(void) {
+    return lineas_completas;
+}
+
+/*carga todos los artículos mapeando el archivo en memoria y leyéndolo una sola vez
+a diferencia de cargar_articulos no cuenta las líneas antes, el arreglo crece mientras se lee
+y no hay límite de largo por línea
+con varios hilos (--hilos) el archivo se corta en pedazos que terminan en '\n', cada hilo
+parsea el suyo en su propia arena y al final se juntan en el orden del archivo
+E: nombre_archivo, total (donde guardar la cantidad cargada), arena para las cadenas (NULL para malloc),
+   fuente (donde copiar el stat del archivo tal como se leyo, puede ser NULL), completos (donde guardar
+   cuantos bytes hay hasta el ultimo '\n'; si no es NULL y solo_lineas_completas() da 1, lo que sigue
+   despues de ese '\n' no se parsea)
+S: arreglo dinámico con todos los artículos, NULL si falla
+R: que el archivo exista y tenga el formato correcto
+*/
+static struct articulo* cargar_mapeado(const char* nombre_archivo, int* total, struct arena* arena, struct stat* fuente,
+                                       size_t* completos) {
+    int fd = open(nombre_archivo, O_RDONLY);
+    if (fd < 0) {
+        printf("Error: no se pudo abrir el archivo %s\n", nombre_archivo);
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        printf("Error: no se pudo leer el tamano de %s\n", nombre_archivo);
+        close(fd);
+        return NULL;
+    }
+
+    size_t tamano = (size_t) info.st_size;
+    const char* datos = NULL;
+    if (tamano > 0) {
+        datos = mmap(NULL, tamano, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (datos == MAP_FAILED) {
+            printf("Error: no se pudo mapear el archivo %s\n", nombre_archivo);
+            close(fd);
+            return NULL;
+        }
+        madvise((void*) datos, tamano, MADV_SEQUENTIAL); //se lee de inicio a fin
+    }
+    close(fd); //el mapeo sigue siendo valido sin el descriptor
+    sumar_bytes_leidos(tamano);
+
+    //hasta el ultimo '\n': una ultima línea sin terminar puede estar a medio escribir
+    size_t bytes_completos = tamano;
+    while (bytes_completos > 0 && datos[bytes_completos - 1] != '\n') {
+        bytes_completos--;
+    }
+    size_t a_parsear = (completos != NULL && solo_lineas_completas()) ? bytes_completos : tamano;
+
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+
+    int hilos = hilos_ordenamiento();
+    if ((size_t) hilos > a_parsear / MINIMO_BYTES_POR_HILO) {
+        hilos = (int) (a_parsear / MINIMO_BYTES_POR_HILO);
+    }
+    if (hilos < 1) hilos = 1;
+
+    struct trabajo_parseo* trabajos = calloc(hilos, sizeof(struct trabajo_parseo));
+    pthread_t* ids = calloc(hilos, sizeof(pthread_t));
+    if (trabajos == NULL || ids == NULL) {
+        printf("Error: no se pudo asignar memoria para los articulos\n");
+        free(trabajos);
+        free(ids);
+        if (datos != NULL) munmap((void*) datos, tamano);
+        return NULL;
+    }
+
+    //cortar en pedazos casi iguales, moviendo cada corte hasta despues del siguiente '\n'
+    const char* fin_datos = datos + a_parsear;
+    const char* corte = datos;
+    for (int h = 0; h < hilos; h++) {
+        trabajos[h].inicio = corte;
+        if (h == hilos - 1) {
+            trabajos[h].fin = fin_datos;
+        } else {
+            const char* objetivo = datos + a_parsear / hilos * (h + 1);
+            if (objetivo < corte) objetivo = corte;
+            const char* salto = memchr(objetivo, '\n', (size_t)(fin_datos - objetivo));
+            trabajos[h].fin = (salto != NULL) ? salto + 1 : fin_datos;
+        }
+        corte = trabajos[h].fin;
+
+        //con un solo hilo las cadenas van directo a la arena del que llama
+        if (hilos == 1 || arena == NULL) {
+            trabajos[h].arena = arena;
+        } else {
+            iniciar_arena(&trabajos[h].arena_propia, 0);
+            trabajos[h].arena = &trabajos[h].arena_propia;
+        }
+
+        if (hilos == 1 || pthread_create(&ids[h], NULL, parsear_pedazo, &trabajos[h]) != 0) {
+            parsear_pedazo(&trabajos[h]); //si no se pudo crear el hilo se parsea aca mismo
+            ids[h] = pthread_self();
+        }
+    }
+
+    int num_articulos = 0;
+    int bien = 1;
+    for (int h = 0; h < hilos; h++) {
+        if (!pthread_equal(ids[h], pthread_self())) {
+            pthread_join(ids[h], NULL);
+        }
+        if (trabajos[h].articulos == NULL) bien = 0;
+        num_articulos += trabajos[h].cantidad;
+    }
+
+    //juntar los pedazos en el orden del archivo
+    struct articulo* articulos = NULL;
+    if (bien && hilos == 1) {
+        articulos = trabajos[0].articulos;
+        trabajos[0].articulos = NULL;
+    } else if (bien) {
+        articulos = malloc((num_articulos > 0 ? num_articulos : 1) * sizeof(struct articulo));
+        if (articulos == NULL) {
+            printf("Error: no se pudo asignar memoria para los articulos\n");
+            bien = 0;
+        }
+        int copiados = 0;
+        for (int h = 0; bien && h < hilos; h++) {
+            memcpy(articulos + copiados, trabajos[h].articulos, trabajos[h].cantidad * sizeof(struct articulo));
+            copiados += trabajos[h].cantidad;
+            free(trabajos[h].articulos);
+            trabajos[h].articulos = NULL;
+            if (trabajos[h].arena == &trabajos[h].arena_propia) {
+                arena_absorber(arena, &trabajos[h].arena_propia);
+            }
+        }
+    }
+
+    //si algo fallo se libera lo que cada hilo alcanzo a parsear
+    for (int h = 0; h < hilos; h++) {
+        if (trabajos[h].articulos != NULL) liberar_pedazo(&trabajos[h]);
+        if (trabajos[h].arena == &trabajos[h].arena_propia) liberar_arena(&trabajos[h].arena_propia);
+    }
+    free(trabajos);
+    free(ids);
+    if (datos != NULL) munmap((void*) datos, tamano);
+    terminar_fase(FASE_PARSEO, &marca);
+    if (!bien) return NULL;
+
+    *total = num_articulos;
+    if (fuente != NULL) *fuente = info;
+    if (completos != NULL) *completos = bytes_completos;
+    informar("Se cargaron %d articulos exitosamente.\n", num_articulos);
     return articulos;
-}
\ No newline at end of file
+}
+
+/*carga todos los artículos mapeando el archivo y leyéndolo una sola vez (ver cargar_mapeado)
+E: nombre_archivo (ruta al archivo índice), total (puntero donde guardar la cantidad de artículos cargados)
+S: arreglo dinámico con todos los artículos, NULL si falla
+R: que el archivo exista y tenga el formato correcto
+*/
+struct articulo* cargar_articulos_mmap(const char* nombre_archivo, int* total) {
+    return cargar_mapeado(nombre_archivo, total, NULL, NULL, NULL);
+}
+
+/*carga el archivo índice en un corpus: las cadenas se copian a una arena en vez de usar
+cinco strdup por artículo, y se liberan todas juntas con destruir_corpus
+E: nombre_archivo (ruta al archivo índice)
+S: puntero al corpus cargado, NULL si falla
+R: que el archivo exista y tenga el formato correcto
+*/
+struct corpus* cargar_corpus(const char* nombre_archivo) {
+    struct corpus* corpus = calloc(1, sizeof(struct corpus));
+    if (corpus == NULL) {
+        printf("Error: no se pudo crear el corpus\n");
+        return NULL;
+    }
+
+    iniciar_arena(&corpus->textos, 0);
+    struct stat fuente;
+    size_t completos = 0;
+    corpus->articulos = cargar_mapeado(nombre_archivo, &corpus->total, &corpus->textos, &fuente, &completos);
+    if (corpus->articulos == NULL) {
+        liberar_arena(&corpus->textos);
+        free(corpus);
+        return NULL;
+    }
+    //la recarga incremental sigue despues del ultimo '\n', nunca en medio de una línea
+    corpus->bytes_fuente = completos;
+    corpus->cola_cargada = (completos < (size_t) fuente.st_size && !solo_lineas_completas());
+    corpus->inodo_fuente = (uint64_t) fuente.st_ino;
+    corpus->dispositivo_fuente = (uint64_t) fuente.st_dev;
+
+    //llaves numericas (año, palabras del título) en sus columnas, se calculan una sola vez al cargar
+    calcular_columnas_derivadas(corpus, 0);
+    return corpus;
+}
+
+/*parsea los registros de [inicio, fin) y los agrega al final del corpus, con sus cadenas en la arena
+del corpus; las columnas derivadas y los ordenamientos los pone al dia quien llama (ver recarga.c)
+E: corpus, inicio y fin del texto nuevo (lineas completas)
+S: cantidad de artículos agregados, -1 si falla (el corpus queda como estaba)
+R: que inicio sea el comienzo de una linea
+*/
+int corpus_agregar_registros(struct corpus* corpus, const char* inicio, const char* fin) {
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+
+    struct trabajo_parseo trabajo = {.inicio = inicio, .fin = fin, .arena = &corpus->textos};
+    parsear_pedazo(&trabajo);
+    if (trabajo.articulos == NULL) return -1;
+
+    int cantidad = trabajo.cantidad;
+    if (cantidad > 0) {
+        struct articulo* articulos = realloc(corpus->articulos, (size_t) (corpus->total + cantidad) * sizeof(struct articulo));
+        if (articulos == NULL) {
+            printf("Error: no se pudo redimensionar el arreglo de articulos\n");
+            free(trabajo.articulos);
+            return -1;
+        }
+        memcpy(articulos + corpus->total, trabajo.articulos, (size_t) cantidad * sizeof(struct articulo));
+        corpus->articulos = articulos;
+        corpus->total += cantidad;
+    }
+    free(trabajo.articulos);
+    terminar_fase(FASE_PARSEO, &marca);
+    return cantidad;
+}
@@ -0,0 +1,430 @@
+#include "heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//indices secundarios de un corpus; se arman con la primera consulta filtrada y se reusan
+struct indices_filtro {
+    //cubetas de años: los artículos del año a son por_ano[inicio_ano[a - ano_minimo] .. inicio_ano[a - ano_minimo + 1])
+    int ano_minimo;
+    int cantidad_anos;    // 0 si los años cubren un rango muy grande (entonces se revisan uno por uno)
+    uint32_t* inicio_ano; // conteos acumulados, cantidad_anos + 1
+    uint32_t* por_ano;    // indices agrupados por año, en el orden del archivo dentro de cada año
+    //autores: llave primaria de "apellido nombre" de cada artículo y los indices ordenados por esa llave
+    const char** llave_autor;
+    uint32_t* por_autor;
+    struct arena llaves;
+};
+
+/*lee un rango de años "2015-2020" (o un solo año "2015")
+E: texto, donde guardar el inicio y el fin
+S: 1 si el rango es valido, 0 si no
+R: ninguna
+*/
+int leer_rango_anos(const char* texto, int* desde, int* hasta) {
+    char* fin;
+    long a = strtol(texto, &fin, 10);
+    if (fin == texto) return 0;
+    long b = a;
+    if (*fin == '-') {
+        const char* segundo = fin + 1;
+        b = strtol(segundo, &fin, 10);
+        if (fin == segundo) return 0;
+    }
+    if (*fin != '\0' || a > b) return 0;
+    *desde = (int) a;
+    *hasta = (int) b;
+    return 1;
+}
+
+/*libera los indices secundarios; se vuelven a armar con la proxima consulta filtrada
+(hay que llamarla cada vez que cambien los artículos del corpus)
+E: corpus
+S: void
+R: ninguna
+*/
+void liberar_indices_filtro(struct corpus* corpus) {
+    struct indices_filtro* indices = corpus->filtros;
+    if (indices == NULL) return;
+
+    free(indices->inicio_ano);
+    free(indices->por_ano);
+    free(indices->llave_autor);
+    free(indices->por_autor);
+    liberar_arena(&indices->llaves);
+    free(indices);
+    corpus->filtros = NULL;
+}
+
+/*año de un artículo, de su columna si esta calculada
+E: corpus, indice del artículo
+S: año
+R: ninguna
+*/
+static inline int ano_de(const struct corpus* corpus, uint32_t indice) {
+    const int* columna = corpus->columnas[COLUMNA_ANO];
+    return (columna != NULL) ? columna[indice] : corpus->articulos[indice].ano;
+}
+
+/*arma las cubetas de años: cuenta cuantos artículos hay de cada año, acumula los conteos
+y reparte los indices, O(n + rango)
+E: corpus, indices (donde guardar las cubetas)
+S: 1 si salio bien (o si el rango era muy grande y no se armaron), 0 si no hubo memoria
+R: que el corpus tenga artículos
+*/
+static int armar_cubetas_anos(const struct corpus* corpus, struct indices_filtro* indices) {
+    int minimo = ano_de(corpus, 0);
+    int maximo = minimo;
+    for (int i = 1; i < corpus->total; i++) {
+        int ano = ano_de(corpus, (uint32_t) i);
+        if (ano < minimo) minimo = ano;
+        if (ano > maximo) maximo = ano;
+    }
+    if ((long long) maximo - minimo + 1 > RANGO_MAXIMO_CONTEO) return 1;
+
+    int cantidad = maximo - minimo + 1;
+    indices->inicio_ano = calloc((size_t) cantidad + 1, sizeof(uint32_t));
+    indices->por_ano = malloc((size_t) corpus->total * sizeof(uint32_t));
+    if (indices->inicio_ano == NULL || indices->por_ano == NULL) return 0;
+
+    for (int i = 0; i < corpus->total; i++) {
+        indices->inicio_ano[ano_de(corpus, (uint32_t) i) - minimo + 1]++;
+    }
+    for (int a = 0; a < cantidad; a++) {
+        indices->inicio_ano[a + 1] += indices->inicio_ano[a];
+    }
+    //repartir usando una copia de los inicios como posicion de escritura de cada cubeta
+    uint32_t* siguiente = malloc((size_t) cantidad * sizeof(uint32_t));
+    if (siguiente == NULL) return 0;
+    memcpy(siguiente, indices->inicio_ano, (size_t) cantidad * sizeof(uint32_t));
+    for (int i = 0; i < corpus->total; i++) {
+        indices->por_ano[siguiente[ano_de(corpus, (uint32_t) i) - minimo]++] = (uint32_t) i;
+    }
+    free(siguiente);
+
+    indices->ano_minimo = minimo;
+    indices->cantidad_anos = cantidad;
+    return 1;
+}
+
+/*arma el arreglo de autores ordenado por la llave primaria de "apellido nombre"
+E: corpus, indices
+S: 1 si salio bien, 0 si no
+R: que el corpus tenga artículos
+*/
+static int armar_autores(const struct corpus* corpus, struct indices_filtro* indices) {
+    indices->llave_autor = malloc((size_t) corpus->total * sizeof(const char*));
+    if (indices->llave_autor == NULL) return 0;
+
+    size_t capacidad = 256;
+    char* texto = malloc(capacidad);
+    if (texto == NULL) return 0;
+
+    for (int i = 0; i < corpus->total; i++) {
+        const struct articulo* art = &corpus->articulos[i];
+        const char* apellido = (art->apellido_autor != NULL) ? art->apellido_autor : "";
+        const char* nombre = (art->nombre_autor != NULL) ? art->nombre_autor : "";
+        size_t largo_apellido = strlen(apellido);
+        size_t largo_nombre = strlen(nombre);
+
+        if (largo_apellido + largo_nombre + 2 > capacidad) {
+            capacidad = largo_apellido + largo_nombre + 2;
+            char* nuevo = realloc(texto, capacidad);
+            if (nuevo == NULL) {
+                free(texto);
+                return 0;
+            }
+            texto = nuevo;
+        }
+        memcpy(texto, apellido, largo_apellido);
+        texto[largo_apellido] = ' ';
+        memcpy(texto + largo_apellido + 1, nombre, largo_nombre + 1);
+
+        indices->llave_autor[i] = crear_llave_primaria(&indices->llaves, texto);
+        if (indices->llave_autor[i] == NULL) {
+            free(texto);
+            return 0;
+        }
+    }
+    free(texto);
+
+    indices->por_autor = ordenar_llaves_alfabeticas_k(indices->llave_autor, corpus->total, corpus->total);
+    return indices->por_autor != NULL;
+}
+
+/*arma los indices secundarios del corpus si todavia no estan
+E: corpus
+S: los indices, NULL si falla
+R: que el corpus tenga artículos
+*/
+static struct indices_filtro* asegurar_indices(struct corpus* corpus) {
+    if (corpus->filtros != NULL) return corpus->filtros;
+
+    struct indices_filtro* indices = calloc(1, sizeof(struct indices_filtro));
+    if (indices == NULL) {
+        fprintf(stderr, "Error: no hay memoria para los indices de filtro.\n");
+        return NULL;
+    }
+    iniciar_arena(&indices->llaves, 0);
+    corpus->filtros = indices;
+
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+    int bien = armar_cubetas_anos(corpus, indices) && armar_autores(corpus, indices);
+    terminar_fase(FASE_INDICES, &marca);
+    if (!bien) {
+        fprintf(stderr, "Error: no se pudieron armar los indices de filtro.\n");
+        liberar_indices_filtro(corpus);
+        return NULL;
+    }
+    return indices;
+}
+
+/*llave primaria de lo que se busca como autor: la coma de "Apellido, Nombre" cuenta como el espacio
+que separa apellido y nombre en la llave de cada artículo, y se quitan los espacios repetidos
+E: arena, texto buscado
+S: llave primaria, NULL si falla
+R: que el texto no sea NULL
+*/
+static char* llave_autor_buscado(struct arena* arena, const char* texto) {
+    size_t largo = strlen(texto);
+    char* limpio = arena_reservar(arena, largo + 1);
+    if (limpio == NULL) return NULL;
+
+    size_t j = 0;
+    for (size_t i = 0; i < largo; i++) {
+        char c = (texto[i] == ',' || texto[i] == '\t') ? ' ' : texto[i];
+        if (c == ' ' && (j == 0 || limpio[j - 1] == ' ')) continue;
+        limpio[j++] = c;
+    }
+    while (j > 0 && limpio[j - 1] == ' ') j--;
+    limpio[j] = '\0';
+    return crear_llave_primaria(arena, limpio);
+}
+
+//lo que un artículo tiene que cumplir, ya convertido a llaves
+struct condiciones {
+    const struct filtro* filtro;
+    const char* autor;    // llave primaria del prefijo de autor, NULL = cualquiera
+    size_t largo_autor;
+    const char* titulo;   // llave primaria del pedazo de título, NULL = cualquiera
+    const uint32_t* encontrados; // resultado de la busqueda por terminos (creciente), NULL = cualquiera
+    int total_encontrados;
+    struct arena* temporal;
+};
+
+static int comparar_indices(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*) a;
+    uint32_t y = *(const uint32_t*) b;
+    return (x > y) - (x < y);
+}
+
+/*revisa si un artículo cumple todo el filtro (los indices solo dan candidatos)
+E: corpus, indices, condiciones, indice del artículo
+S: 1 si cumple, 0 si no
+R: ninguna
+*/
+static int cumple(const struct corpus* corpus, const struct indices_filtro* indices,
+                  const struct condiciones* condiciones, uint32_t indice) {
+    const struct filtro* filtro = condiciones->filtro;
+    if (filtro->con_anos) {
+        int ano = ano_de(corpus, indice);
+        if (ano < filtro->ano_desde || ano > filtro->ano_hasta) return 0;
+    }
+    if (condiciones->autor != NULL &&
+        strncmp(indices->llave_autor[indice], condiciones->autor, condiciones->largo_autor) != 0) {
+        return 0;
+    }
+    if (condiciones->titulo != NULL) {
+        const char* titulo = crear_llave_primaria(condiciones->temporal, corpus->articulos[indice].titulo_articulo);
+        if (titulo == NULL || strstr(titulo, condiciones->titulo) == NULL) return 0;
+    }
+    if (condiciones->encontrados != NULL &&
+        bsearch(&indice, condiciones->encontrados, (size_t) condiciones->total_encontrados, sizeof(uint32_t),
+                comparar_indices) == NULL) {
+        return 0;
+    }
+    return 1;
+}
+
+/*ordena un subconjunto de artículos por el criterio: se juntan solo sus llaves y se ordenan con los heaps
+E: corpus, criterio, indices del subconjunto, m (cuantos), k, arena para las llaves alfabéticas
+S: arreglo nuevo con los k primeros indices del corpus en orden, NULL si falla
+R: que 1 <= k <= m
+*/
+static uint32_t* ordenar_subconjunto(struct corpus* corpus, enum criterio_orden criterio, const uint32_t* subconjunto,
+                                     int m, int k, struct arena* arena) {
+    uint32_t* orden;
+    int columna = columna_de_criterio(criterio);
+    if (columna >= 0) {
+        int* llaves = malloc((size_t) m * sizeof(int));
+        if (llaves == NULL) return NULL;
+        for (int i = 0; i < m; i++) {
+            if (corpus->columnas[columna] != NULL) {
+                llaves[i] = corpus->columnas[columna][subconjunto[i]];
+            } else {
+                llenar_llaves_numericas(&corpus->articulos[subconjunto[i]], 1, criterio, &llaves[i]);
+            }
+        }
+        orden = ordenar_llaves_numericas_k(llaves, m, k);
+        free(llaves);
+    } else {
+        const char** llaves = malloc((size_t) m * sizeof(const char*));
+        if (llaves == NULL) return NULL;
+        int bien = 1;
+        for (int i = 0; i < m && bien; i++) {
+            const struct articulo* art = &corpus->articulos[subconjunto[i]];
+            llaves[i] = crear_llave_colacion(arena, (criterio == CRITERIO_TITULO) ? art->titulo_articulo : art->ruta);
+            bien = (llaves[i] != NULL);
+        }
+        orden = bien ? ordenar_llaves_alfabeticas_k(llaves, m, k) : NULL;
+        free(llaves);
+    }
+    if (orden == NULL) return NULL;
+
+    //los indices salen relativos al subconjunto
+    for (int i = 0; i < k; i++) {
+        orden[i] = subconjunto[orden[i]];
+    }
+    return orden;
+}
+
+/*primera posicion de por_autor cuya llave, cortada al largo del prefijo, no es menor (o no es menor
+ni igual, con despues = 1) que el prefijo; los que empiezan con el prefijo quedan entre las dos
+E: indices, total de artículos, prefijo, largo, despues
+S: posicion en por_autor
+R: que por_autor este ordenado
+*/
+static int buscar_autor(const struct indices_filtro* indices, int total, const char* prefijo, size_t largo, int despues) {
+    int bajo = 0;
+    int alto = total;
+    while (bajo < alto) {
+        int medio = bajo + (alto - bajo) / 2;
+        int comparacion = strncmp(indices->llave_autor[indices->por_autor[medio]], prefijo, largo);
+        if (comparacion < 0 || (despues && comparacion == 0)) {
+            bajo = medio + 1;
+        } else {
+            alto = medio;
+        }
+    }
+    return bajo;
+}
+
+/*corre una consulta filtrada: los indices dan los candidatos (la cubeta de años, el rango de autores
+o los artículos que tienen los terminos buscados, el que sea mas chico), se revisa el resto del filtro solo sobre esos y se ordenan solo los que cumplen.
+sin filtro de años, autor ni terminos se recorre el orden del criterio hasta juntar el limite
+(con un orden compuesto se revisan todos y se ordenan los que cumplen)
+E: corpus, filtro, criterio, orden compuesto (NULL = por el criterio), limite (0 = todos),
+   cantidad (donde guardar cuantos indices se devuelven)
+S: arreglo nuevo con los indices en orden (hay que liberarlo), NULL si falla
+R: que el corpus este cargado
+*/
+uint32_t* corpus_filtrar(struct corpus* corpus, const struct filtro* filtro, enum criterio_orden criterio,
+                         const struct orden_compuesto* compuesto, int limite, int* cantidad) {
+    *cantidad = 0;
+    if (corpus->total == 0) return malloc(sizeof(uint32_t));
+
+    //los indices de años y autores solo hacen falta si se filtra por eso
+    struct indices_filtro* indices = NULL;
+    if (filtro->con_anos || filtro->autor != NULL) {
+        indices = asegurar_indices(corpus);
+        if (indices == NULL) return NULL;
+    }
+
+    struct arena temporal;
+    iniciar_arena(&temporal, 0);
+    struct condiciones condiciones = {filtro, NULL, 0, NULL, NULL, 0, &temporal};
+    if (filtro->autor != NULL) {
+        condiciones.autor = llave_autor_buscado(&temporal, filtro->autor);
+        condiciones.largo_autor = (condiciones.autor != NULL) ? strlen(condiciones.autor) : 0;
+    }
+    if (filtro->titulo != NULL) {
+        condiciones.titulo = crear_llave_primaria(&temporal, filtro->titulo);
+    }
+    if ((filtro->autor != NULL && condiciones.autor == NULL) || (filtro->titulo != NULL && condiciones.titulo == NULL)) {
+        liberar_arena(&temporal);
+        return NULL;
+    }
+    uint32_t* encontrados = NULL;
+    if (filtro->buscar != NULL) {
+        encontrados = corpus_buscar(corpus, filtro->buscar, &condiciones.total_encontrados);
+        if (encontrados == NULL) {
+            liberar_arena(&temporal);
+            return NULL;
+        }
+        condiciones.encontrados = encontrados;
+    }
+
+    //candidatos: el rango mas chico que den los indices
+    const uint32_t* candidatos = NULL;
+    int total_candidatos = corpus->total;
+    if (filtro->con_anos && indices->cantidad_anos > 0) {
+        long long desde = (long long) filtro->ano_desde - indices->ano_minimo;
+        long long hasta = (long long) filtro->ano_hasta - indices->ano_minimo;
+        if (desde < 0) desde = 0;
+        if (hasta > indices->cantidad_anos - 1) hasta = indices->cantidad_anos - 1;
+        uint32_t inicio = (desde <= hasta) ? indices->inicio_ano[desde] : 0;
+        uint32_t fin = (desde <= hasta) ? indices->inicio_ano[hasta + 1] : 0;
+        candidatos = indices->por_ano + inicio;
+        total_candidatos = (int) (fin - inicio);
+    }
+    if (condiciones.autor != NULL) {
+        int inicio = buscar_autor(indices, corpus->total, condiciones.autor, condiciones.largo_autor, 0);
+        int fin = buscar_autor(indices, corpus->total, condiciones.autor, condiciones.largo_autor, 1);
+        if (fin - inicio < total_candidatos) {
+            candidatos = indices->por_autor + inicio;
+            total_candidatos = fin - inicio;
+        }
+    }
+    if (encontrados != NULL && condiciones.total_encontrados < total_candidatos) {
+        candidatos = encontrados;
+        total_candidatos = condiciones.total_encontrados;
+    }
+
+    //sin indice que sirva: se recorre el orden del criterio y se para al llegar al limite
+    //(con un orden compuesto no hay orden guardado: se revisan todos en el orden del índice)
+    int ya_ordenados = 0;
+    if (candidatos == NULL && compuesto == NULL) {
+        candidatos = corpus_obtener_orden(corpus, criterio, corpus->total);
+        if (candidatos == NULL) {
+            free(encontrados);
+            liberar_arena(&temporal);
+            return NULL;
+        }
+        ya_ordenados = 1;
+    }
+    if (limite <= 0) limite = corpus->total;
+
+    uint32_t* cumplen = malloc((size_t) (total_candidatos > 0 ? total_candidatos : 1) * sizeof(uint32_t));
+    if (cumplen == NULL) {
+        free(encontrados);
+        liberar_arena(&temporal);
+        return NULL;
+    }
+    int m = 0;
+    for (int i = 0; i < total_candidatos && !(ya_ordenados && m == limite); i++) {
+        uint32_t candidato = (candidatos != NULL) ? candidatos[i] : (uint32_t) i;
+        if (cumple(corpus, indices, &condiciones, candidato)) {
+            cumplen[m++] = candidato;
+        }
+    }
+
+    uint32_t* resultado = cumplen;
+    int k = (m < limite) ? m : limite;
+    if (!ya_ordenados && k > 0) {
+        //los heaps desempatan por posicion: con los candidatos de por_ano o por_autor esa posicion no es
+        //la del índice, y los empates (y lo que corta --limit) saldrian distinto que sin filtro
+        if (candidatos != NULL && candidatos != encontrados) {
+            qsort(cumplen, (size_t) m, sizeof(uint32_t), comparar_indices);
+        }
+        resultado = (compuesto != NULL) ? ordenar_compuesto_k(corpus, compuesto, cumplen, m, k)
+                                        : ordenar_subconjunto(corpus, criterio, cumplen, m, k, &temporal);
+        free(cumplen);
+    }
+    free(encontrados);
+    liberar_arena(&temporal);
+    if (resultado == NULL) return NULL;
+
+    *cantidad = k;
+    return resultado;
+}
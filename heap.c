@@ -1,8 +1,61 @@
 #include "heap.h"
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+//si los mensajes informativos (no los errores) se imprimen en stdout
+static int mensajes_activos = 1;
+
+/*prende o apaga los mensajes informativos como "Se cargaron N articulos"; en modo por lotes
+se apagan para que stdout tenga solo los resultados
+E: activos (1 = imprimir, 0 = callar)
+S: void
+R: ninguna
+*/
+void configurar_mensajes(int activos) {
+    mensajes_activos = activos;
+}
+
+/*imprime un mensaje informativo con formato de printf, solo si los mensajes estan activos
+E: formato y argumentos como printf
+S: void
+R: ninguna
+*/
+void informar(const char* formato, ...) {
+    if (!mensajes_activos) return;
+
+    va_list argumentos;
+    va_start(argumentos, formato);
+    vprintf(formato, argumentos);
+    va_end(argumentos);
+}
+
+//cantidad de hijos por nodo que usan los heaps nuevos (2 = heap binario clasico)
+static int aridad_configurada = 2;
+
+/*cambia la cantidad de hijos por nodo de los heaps que se creen despues
+E: aridad (entre 2 y ARIDAD_HEAP_MAXIMA)
+S: void
+R: si la aridad no es valida se deja la anterior
+*/
+void configurar_aridad_heaps(int aridad) {
+    if (aridad < 2 || aridad > ARIDAD_HEAP_MAXIMA) {
+        fprintf(stderr, "Advertencia: aridad %d invalida, se mantiene %d.\n", aridad, aridad_configurada);
+        return;
+    }
+    aridad_configurada = aridad;
+}
+
+/*devuelve la aridad que usan los heaps nuevos
+E: ninguna
+S: cantidad de hijos por nodo
+R: ninguna
+*/
+int aridad_heaps(void) {
+    return aridad_configurada;
+}
+
 /*crea una copia en memoria de una cadena de caracteres (string duplicate)
 E: cadena de caracteres original
 S: puntero a la nueva cadena de caracteres en memoria
@@ -56,9 +109,10 @@ void liberar_articulo(struct articulo* art) {
 }
 
 /*cuenta la cantidad de palabras en una cadena de caracteres
+(el conteo es el de contar_palabras_largo en escaner.c, por bloques con SIMD)
 E: texto (cadena de caracteres)
 S: cantidad de palabras en la cadena
-R: que el texto no sea NULL
+R: ninguna (NULL cuenta como 0 palabras)
 */
 int contar_palabras(const char *texto) {
     //validaciones
@@ -66,20 +120,45 @@ int contar_palabras(const char *texto) {
         return 0;
     }
 
-    int contador = 0;
-    int en_palabra = 0; //para saber si esta o no dentro de una palabra (1 = si, 0 = no)
-
-    while (*texto) {
-        if (*texto == ' ' || *texto == '\n' || *texto == '\t') {
-            en_palabra = 0;
-        } else {
-            if (!en_palabra) {
-                contador++;
-                en_palabra = 1;
-            }
-        }
-        texto++;
+    return contar_palabras_largo(texto, strlen(texto));
+}
+
+/*devuelve los indices de los primeros k artículos segun el criterio, sin ordenar el resto
+E: articulos, n (cantidad de artículos), criterio, k (cuantos se quieren)
+S: arreglo de k indices en orden, NULL si falla
+R: que 1 <= k <= n
+*/
+uint32_t* ordenar_top_k(struct articulo* articulos, int n, enum criterio_orden criterio, int k) {
+    switch (criterio) {
+        case CRITERIO_TITULO:
+            return ordenar_por_titulo_k(articulos, n, k);
+        case CRITERIO_PALABRAS:
+            return ordenar_por_palabras_titulo_k(articulos, n, k);
+        case CRITERIO_RUTA:
+            return ordenar_por_nombre_archivo_k(articulos, n, k);
+        case CRITERIO_ANO:
+            return ordenar_por_ano_k(articulos, n, k);
+        default:
+            fprintf(stderr, "Error: criterio de ordenamiento desconocido.\n");
+            return NULL;
     }
+}
 
-    return contador;
+/*convierte el nombre de un criterio (como se escribe en la linea de comandos) al enum
+E: nombre ("titulo", "palabras", "ruta" o "ano", o en ingles "title", "words", "path" o "year"),
+   criterio (donde guardar el resultado)
+S: 1 si el nombre es valido, 0 si no
+R: que los punteros no sean NULL
+*/
+int leer_criterio(const char* nombre, enum criterio_orden* criterio) {
+    static const char* nombres[TOTAL_CRITERIOS] = {"titulo", "palabras", "ruta", "ano"};
+    static const char* en_ingles[TOTAL_CRITERIOS] = {"title", "words", "path", "year"};
+
+    for (int c = 0; c < TOTAL_CRITERIOS; c++) {
+        if (strcmp(nombre, nombres[c]) == 0 || strcmp(nombre, en_ingles[c]) == 0) {
+            *criterio = (enum criterio_orden) c;
+            return 1;
+        }
+    }
+    return 0;
 }
\ No newline at end of file
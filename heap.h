@@ -1,6 +1,7 @@
 #ifndef HEAP_H
 #define HEAP_H
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -14,58 +15,342 @@ struct articulo {
     char* resumen;
 };
 
+// criterios de ordenamiento del menu
+enum criterio_orden {
+    CRITERIO_TITULO,
+    CRITERIO_PALABRAS,
+    CRITERIO_RUTA,
+    CRITERIO_ANO,
+    TOTAL_CRITERIOS
+};
+
+// valor que devuelven los heaps cuando no hay indice que extraer
+#define INDICE_INVALIDO UINT32_MAX
+
 //HEAP NUMERICO: para cantidad de palabras en el titulo y año
+//el nodo solo guarda la posicion del articulo en el arreglo original (8 bytes por nodo)
 struct nodo_heap_numerico {
-    struct articulo articulo;
     int llave;
+    uint32_t indice;
 };
 
 struct heap_numerico {
     struct nodo_heap_numerico* nodos;
     int tamano;
     int capacidad;
+    int aridad; // hijos por nodo: 2 (binario) o 4 (los 4 hijos caben en una linea de cache)
 };
 
 //funciones
 struct heap_numerico* crear_heap_numerico(int capacidad_inicial);
-void insertar_heap_numerico(struct heap_numerico* heap, struct articulo articulo, int llave);
-struct articulo extraer_min_heap_numerico(struct heap_numerico* heap);
+void insertar_heap_numerico(struct heap_numerico* heap, uint32_t indice, int llave);
+void agregar_sin_ordenar_heap_numerico(struct heap_numerico* heap, uint32_t indice, int llave);
+void construir_heap_numerico(struct heap_numerico* heap); // heapify de abajo hacia arriba, O(n)
+uint32_t extraer_min_heap_numerico(struct heap_numerico* heap);
 int heap_numerico_vacio(struct heap_numerico* heap);
 void destruir_heap_numerico(struct heap_numerico* heap);
 
-// Funciones de ordenamiento numérico
-struct articulo* ordenar_por_ano(struct articulo* articulos, int n);
-struct articulo* ordenar_por_palabras_titulo(struct articulo* articulos, int n);
+// Funciones de ordenamiento numérico: devuelven la permutacion (indices de articulos en orden)
+uint32_t* ordenar_por_ano(struct articulo* articulos, int n);
+uint32_t* ordenar_por_palabras_titulo(struct articulo* articulos, int n);
+// Versiones top-k: solo extraen los primeros k, O(n + k log n)
+// (si las llaves caben en un rango pequeño se usa counting sort estable, O(n + rango))
+#define RANGO_MAXIMO_CONTEO (1 << 16)
+uint32_t* ordenar_llaves_numericas_k(const int* llaves, int n, int k);
+void llenar_llaves_numericas(const struct articulo* articulos, int n, enum criterio_orden criterio, int* destino);
+uint32_t* ordenar_por_ano_k(struct articulo* articulos, int n, int k);
+uint32_t* ordenar_por_palabras_titulo_k(struct articulo* articulos, int n, int k);
 
 //HEAP ALFABETICO: para nombre de archivo o titulo
+//el nodo guarda los primeros 8 bytes de la llave como entero big-endian para comparar
+//con enteros, y la llave completa (prestada, no se copia) solo para desempatar
 struct nodo_heap_alfabetico {
-    struct articulo articulo;
-    char* llave;  // Llave alfabética (puede ser título o filename)
+    uint64_t prefijo;
+    const char* llave;  // Llave alfabética (puede ser título o filename)
+    uint32_t indice;
 };
 
 struct heap_alfabetico {
     struct nodo_heap_alfabetico* nodos;
     int tamano;
     int capacidad;
+    int aridad; // hijos por nodo: 2 (binario) o 4
+    size_t desplazamiento;  // bytes iniciales que comparten todas las llaves y no se comparan
+    const char* referencia; // una llave del heap para revisar ese prefijo comun
 };
 
 //funciones
 struct heap_alfabetico* crear_heap_alfabetico(int capacidad_inicial);
-void insertar_heap_alfabetico(struct heap_alfabetico *heap, struct articulo articulo, const char *llave);
-struct articulo extraer_min_heap_alfabetico(struct heap_alfabetico* heap);
+void insertar_heap_alfabetico(struct heap_alfabetico *heap, uint32_t indice, const char *llave);
+void agregar_sin_ordenar_heap_alfabetico(struct heap_alfabetico *heap, uint32_t indice, const char *llave);
+void construir_heap_alfabetico(struct heap_alfabetico* heap); // heapify de abajo hacia arriba, O(n)
+uint32_t extraer_min_heap_alfabetico(struct heap_alfabetico* heap);
 int heap_alfabetico_vacio(struct heap_alfabetico* heap);
 void destruir_heap_alfabetico(struct heap_alfabetico* heap);
 
-// Funciones de ordenamiento alfabético
-struct articulo* ordenar_por_titulo(struct articulo* articulos, int n);
-struct articulo* ordenar_por_nombre_archivo(struct articulo* articulos, int n);
+// Funciones de ordenamiento alfabético: devuelven la permutacion (indices de articulos en orden)
+uint32_t* ordenar_por_titulo(struct articulo* articulos, int n);
+uint32_t* ordenar_por_nombre_archivo(struct articulo* articulos, int n);
+// Versiones top-k: solo extraen los primeros k, O(n + k log n)
+// (comparan llaves de colacion: sin importar mayusculas ni tildes, ver colacion.c)
+uint32_t* ordenar_llaves_alfabeticas_k(const char* const* llaves, int n, int k);
+uint32_t* ordenar_por_titulo_k(struct articulo* articulos, int n, int k);
+uint32_t* ordenar_por_nombre_archivo_k(struct articulo* articulos, int n, int k);
 
 //FUNCIONES PARA LOS DOS
+#define ARIDAD_HEAP_MAXIMA 8
+void configurar_aridad_heaps(int aridad); // aridad que usan los heaps creados de aqui en adelante
+int aridad_heaps(void);
+void configurar_mensajes(int activos);
+void informar(const char* formato, ...); // printf de mensajes informativos (se callan en modo por lotes)
+
+uint32_t* ordenar_top_k(struct articulo* articulos, int n, enum criterio_orden criterio, int k);
+int leer_criterio(const char* nombre, enum criterio_orden* criterio); // "titulo", "palabras", "ruta" o "ano"
+
+// Ordenamiento en varios hilos (esto está en ordenamiento_paralelo.c)
+#define HILOS_MAXIMOS 256
+void configurar_hilos_ordenamiento(int hilos);
+int hilos_ordenamiento(void);
+uint32_t* ordenar_paralelo_top_k(struct articulo* articulos, int n, enum criterio_orden criterio, int k);
 int contar_palabras(const char *texto);
 struct articulo crear_articulo(const char* nombre, const char* apellido, const char* titulo, const char* ruta, int ano, const char* resumen);
 void liberar_articulo(struct articulo* art);
 
+//ARENA: memoria por bloques para las cadenas de los artículos
+#define TAMANO_BLOQUE_ARENA (1 << 20) // 1 MB por bloque
+
+struct bloque_arena {
+    struct bloque_arena* siguiente;
+    size_t usado;
+    size_t capacidad;
+    char datos[];
+};
+
+struct arena {
+    struct bloque_arena* bloques; // el primero es el bloque donde se esta escribiendo
+    size_t tamano_bloque;
+};
+
+void iniciar_arena(struct arena* arena, size_t tamano_bloque);
+void* arena_reservar(struct arena* arena, size_t bytes);
+char* arena_copiar(struct arena* arena, const char* inicio, size_t largo);
+void arena_absorber(struct arena* destino, struct arena* origen); // junta las arenas de varios hilos
+void vaciar_arena(struct arena* arena); // la deja vacia pero se queda con un bloque para reusarlo
+void liberar_arena(struct arena* arena);
+
+//COLACION: llaves para ordenar texto en español sin importar mayusculas ni tildes (esto está en colacion.c)
+char* crear_llave_colacion(struct arena* arena, const char* texto);
+char* crear_llave_primaria(struct arena* arena, const char* texto); // sin el desempate, para prefijos
+size_t escribir_llave_colacion(const char* texto, char* destino); // destino NULL = solo medir
+const char* siguiente_termino(const char* texto, char* destino, size_t capacidad, size_t* largo);
+int llenar_llaves_alfabeticas(const struct articulo* articulos, int n, enum criterio_orden criterio,
+                              struct arena* arena, const char** destino);
+
+//CORPUS: los artículos cargados junto con la arena dueña de todas sus cadenas
+//y los ordenamientos ya calculados para cada criterio
+struct orden_guardado {
+    uint32_t* indices; // NULL si todavia no se ha ordenado por ese criterio
+    int largo;         // cuantos de los primeros indices son validos
+    int del_mapa;      // 1 si los indices estan dentro de la cache mapeada (no se liberan)
+};
+
+//columnas derivadas: una llave numerica por artículo, calculada una sola vez al cargar
+//(o mapeada de la cache), asi ordenar por un criterio numerico no vuelve a leer los artículos
+enum columna_derivada {
+    COLUMNA_ANO,
+    COLUMNA_PALABRAS_TITULO,
+    TOTAL_COLUMNAS
+};
+
+struct indices_filtro;
+struct indice_busqueda;
+
+struct corpus {
+    struct articulo* articulos;
+    int total;
+    struct arena textos;
+    int* columnas[TOTAL_COLUMNAS]; // NULL si esa columna no se calculo
+    int columnas_del_mapa;         // 1 si las columnas estan dentro de la cache mapeada (no se liberan)
+    size_t bytes_fuente;           // bytes del índice de texto ya cargados, hasta el ultimo '\n' (lo que sigue es nuevo)
+    int cola_cargada;              // 1 si tambien se cargo una ultima línea sin '\n' (despues de bytes_fuente)
+    uint64_t inodo_fuente;         // inodo y dispositivo del índice, para saber si lo reemplazaron
+    uint64_t dispositivo_fuente;
+    void* mapa;           // cache binaria mapeada (NULL si se cargo del texto)
+    size_t largo_mapa;
+    struct orden_guardado ordenes[TOTAL_CRITERIOS];
+    struct indices_filtro* filtros; // indices secundarios, NULL hasta la primera consulta filtrada
+    struct indice_busqueda* busqueda; // índice invertido del título y el resumen, NULL hasta la primera busqueda
+};
+
+struct corpus* cargar_corpus(const char* nombre_archivo); // esto está en el file_parser.c
+void configurar_solo_lineas_completas(int activas); // 1: una ultima línea sin '\n' no se carga (modo vigilar)
+int solo_lineas_completas(void);
+int corpus_agregar_registros(struct corpus* corpus, const char* inicio, const char* fin); // también en file_parser.c
+void destruir_corpus(struct corpus* corpus);
+const uint32_t* corpus_obtener_orden(struct corpus* corpus, enum criterio_orden criterio, int k);
+void corpus_invalidar_orden(struct corpus* corpus, enum criterio_orden criterio);
+void corpus_invalidar_ordenes(struct corpus* corpus); // llamar cada vez que cambien los articulos
+int calcular_columnas_derivadas(struct corpus* corpus, int desde);
+int columna_de_criterio(enum criterio_orden criterio); // -1 si el criterio no es numerico
+uint32_t* corpus_ordenar_rango(struct corpus* corpus, enum criterio_orden criterio, int desde, int k);
+
+//ORDEN COMPUESTO: varios campos, cada uno ascendente o descendente, por ejemplo "ano:desc,autor,titulo"
+//(esto está en orden_compuesto.c); los primeros campos valen lo mismo que el criterio del mismo nombre
+enum campo_orden {
+    POR_TITULO,
+    POR_PALABRAS,
+    POR_RUTA,
+    POR_ANO,
+    POR_AUTOR,
+    TOTAL_CAMPOS_ORDEN
+};
+
+#define MAXIMO_CAMPOS_ORDEN 8
+
+struct orden_compuesto {
+    int cantidad;
+    enum campo_orden campos[MAXIMO_CAMPOS_ORDEN];
+    int descendente[MAXIMO_CAMPOS_ORDEN]; // 1 si ese campo va de mayor a menor
+};
+
+int leer_orden_compuesto(const char* texto, struct orden_compuesto* orden);
+uint32_t* ordenar_compuesto_k(struct corpus* corpus, const struct orden_compuesto* orden, const uint32_t* subconjunto,
+                              int m, int k);
+
+//FILTROS: indices secundarios (cubetas de años, autores ordenados) que se arman una vez por corpus
+//para que una consulta filtrada revise solo los artículos que pueden cumplir (esto está en filtros.c)
+struct filtro {
+    int con_anos;       // 1 si se pidio un rango de años
+    int ano_desde;
+    int ano_hasta;
+    const char* autor;  // prefijo de "apellido nombre" o "Apellido, Nombre" (sin importar mayusculas ni tildes), NULL = cualquiera
+    const char* titulo; // pedazo que tiene que aparecer en el título, NULL = cualquiera
+    const char* buscar; // terminos del título o el resumen (ver corpus_buscar), NULL = cualquiera
+};
+
+int leer_rango_anos(const char* texto, int* desde, int* hasta);
+// con compuesto (no NULL) se ordena por esos campos en vez del criterio
+uint32_t* corpus_filtrar(struct corpus* corpus, const struct filtro* filtro, enum criterio_orden criterio,
+                         const struct orden_compuesto* compuesto, int limite, int* cantidad);
+void liberar_indices_filtro(struct corpus* corpus);
+
+//BUSQUEDA: índice invertido de los terminos del título y el resumen, con las listas de artículos
+//comprimidas en varint, y su archivo .busqueda junto al índice (esto está en busqueda.c)
+uint32_t* corpus_buscar(struct corpus* corpus, const char* consulta, int* cantidad);
+int preparar_indice_busqueda(struct corpus* corpus, const char* nombre_archivo, int guardar);
+void liberar_indice_busqueda(struct corpus* corpus);
+
+//CACHE BINARIA: el corpus guardado por columnas junto al índice (esto está en cache_binario.c)
+struct stat;
+char* ruta_cache_binario(const char* nombre_archivo);
+int guardar_cache_binario(struct corpus* corpus, const char* ruta_cache, const struct stat* fuente);
+struct corpus* cargar_corpus_con_cache(const char* nombre_archivo);
+
+//RECARGA INCREMENTAL: agrega lo que se escribio al final del índice y lo mezcla en los ordenes ya calculados
+//(esto está en recarga.c)
+struct vigilante {
+    const char* ruta;
+    int fd;       // inotify, -1 si se revisa por sondeo
+    int vigilado; // descriptor de inotify_add_watch, -1 si el archivo no esta
+};
+
+int corpus_actualizar(struct corpus* corpus, const char* nombre_archivo);
+void iniciar_vigilante(struct vigilante* vigilante, const char* ruta);
+int esperar_cambio(struct vigilante* vigilante); // 1 sigue, 0 SIGINT/SIGTERM, -1 error
+void terminar_vigilante(struct vigilante* vigilante);
+
 // Función para cargar artículos desde archivo esto está en el file_parser.c
 struct articulo* cargar_articulos(const char* nombre_archivo, int* total);
+// Igual que cargar_articulos pero mapea el archivo (mmap) y lo recorre una sola vez
+struct articulo* cargar_articulos_mmap(const char* nombre_archivo, int* total);
+// Parsea un registro [inicio, fin) sin el salto de línea; las cadenas van a la arena (NULL = malloc)
+struct articulo parsear_registro(struct arena* arena, const char* inicio, const char* fin);
+
+// Escaner de delimitadores '|', '\n' y '\r' con SSE2/AVX2 segun el procesador (esto está en escaner.c)
+#define CAMPOS_REGISTRO 6 // nombre, apellido, titulo, ruta, año, resumen
+
+struct campos_registro {
+    const char* inicio[CAMPOS_REGISTRO];
+    size_t largo[CAMPOS_REGISTRO];
+    int cantidad; // campos encontrados (puede pasar de CAMPOS_REGISTRO, los de mas se ignoran)
+};
+
+const char* separar_registro(const char* inicio, const char* fin, struct campos_registro* campos);
+int configurar_escaner(const char* nombre); // "avx2", "sse2" o "escalar"
+const char* escaner_actual(void);
+int contar_palabras_largo(const char* texto, size_t largo); // mismo escaner para espacios ' ', '\n', '\t'
+
+// Ordenamiento externo para archivos que no caben en memoria (esto está en ordenamiento_externo.c)
+#define MEMORIA_EXTERNO_POR_DEFECTO ((size_t) 256 << 20) // 256 MB por corrida (texto, llaves y arreglos)
+#define MEZCLA_EXTERNO_MAXIMA 64 // corridas abiertas a la vez en cada pasada de la mezcla
+int ordenar_externo(const char* entrada, const char* salida, enum criterio_orden criterio,
+                    size_t memoria_maxima, const char* directorio_temporal);
+
+//SALIDA: resultados formateados en un buffer grande y escritos con write/writev (esto está en salida.c)
+#define TAMANO_BUFFER_SALIDA (1 << 16) // 64 KB
+
+enum formato_salida {FORMATO_HUMANO, FORMATO_TSV, FORMATO_JSON, FORMATO_RUTAS};
+
+// campos que se pueden mostrar (se combinan con |)
+#define CAMPO_TITULO  (1u << 0)
+#define CAMPO_AUTOR   (1u << 1)
+#define CAMPO_ANO     (1u << 2)
+#define CAMPO_RUTA    (1u << 3)
+#define CAMPO_RESUMEN (1u << 4)
+#define CAMPOS_TODOS  (CAMPO_TITULO | CAMPO_AUTOR | CAMPO_ANO | CAMPO_RUTA | CAMPO_RESUMEN)
+
+struct escritor {
+    int fd;
+    int error;
+    size_t usado;
+    char buffer[TAMANO_BUFFER_SALIDA];
+};
+
+void iniciar_escritor(struct escritor* escritor, int fd);
+void escritor_agregar(struct escritor* escritor, const char* datos, size_t largo);
+int vaciar_escritor(struct escritor* escritor);
+int escribir_articulos(int fd, const struct articulo* articulos, const uint32_t* orden, int n,
+                       const char* criterio, enum formato_salida formato, unsigned campos);
+void configurar_salida(enum formato_salida formato, unsigned campos); // lo que usa imprimir_articulos
+enum formato_salida formato_salida(void);
+unsigned campos_salida(void);
+int leer_formato(const char* nombre, enum formato_salida* formato); // "humano", "tsv", "json" o "rutas"
+int leer_campos(const char* lista, unsigned* campos); // "titulo,autor,ano,ruta,resumen"
+
+//ESTADISTICAS: tiempos por fase y contadores de los heaps para --stats (esto está en estadisticas.c)
+//las fases no se solapan: si una se abre dentro de otra, su tiempo se descuenta de la de afuera
+//(FASE_ORDEN_HILOS es la espera del hilo principal mientras los hilos ordenan sus pedazos)
+enum fase {FASE_CARGA, FASE_PARSEO, FASE_LLAVES, FASE_INDICES, FASE_CONSTRUCCION, FASE_EXTRACCION,
+           FASE_ORDEN_HILOS, FASE_IMPRESION, TOTAL_FASES};
+
+struct marca_tiempo {
+    double pared;
+    double cpu;
+    int nivel; // profundidad entre las fases abiertas del hilo, -1 si no se anido
+};
+
+struct contadores_heap {
+    uint64_t comparaciones;
+    uint64_t intercambios;
+    uint64_t realocaciones; // de asegurar_capacidad_*
+    uint64_t llaves;        // llaves de colacion creadas
+};
+
+// los contadores solo existen si se compila con -DESTADISTICAS (make ESTADISTICAS=1);
+// son por hilo para no pelear por la misma linea de cache, y sin la bandera no cuestan nada
+#ifdef ESTADISTICAS
+extern _Thread_local struct contadores_heap contadores_hilo;
+#define CONTAR(campo) (contadores_hilo.campo++)
+#else
+#define CONTAR(campo) ((void) 0)
+#endif
+
+void configurar_estadisticas(int activas);
+int estadisticas_activas(void);
+void iniciar_fase(struct marca_tiempo* marca);
+void terminar_fase(enum fase fase, const struct marca_tiempo* marca);
+void sumar_bytes_leidos(size_t bytes);
+void acumular_contadores_hilo(void); // lo llama cada hilo de trabajo al terminar
+void reportar_estadisticas(void);    // una linea clave=valor en stderr
 
 #endif
\ No newline at end of file
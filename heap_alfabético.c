@@ -1,112 +1,90 @@
 #include "heap.h"
+#include "heap_generico.h"
 #include <stdio.h>   // fprintf
-#include <stdlib.h>  // malloc, free, realloc
-#include <string.h>  // strcmp, strlen, memcpy
+#include <stdlib.h>  // malloc, free
+#include <string.h>  // strcmp, strlen
 
-
-
-/*copia una llave alfabética en memoria
-E: llave a copiar
-S: puntero a la copia de la llave
+/*arma el prefijo de 8 bytes de una llave como entero big-endian (rellenado con ceros),
+asi comparar dos prefijos como enteros da lo mismo que strcmp sobre esos 8 bytes
+E: llave (ya desplazada)
+S: prefijo como entero de 64 bits
 R: que la llave no sea NULL
 */
-static char* copiar_llave_alfabetica(const char* llave) {
-    if (llave == NULL) return NULL;
-    size_t len = strlen(llave) + 1; // +1 para el carácter nulo
-    char* copia = calloc(1, len); // Asigna memoria en el heap para la copia
-    if (copia != NULL) {
-        memcpy(copia, llave, len); // Copia el contenido de la cadena original a la nueva ubicación
+static uint64_t calcular_prefijo(const char* llave) {
+    uint64_t prefijo = 0;
+    int i = 0;
+    while (i < 8 && llave[i] != '\0') {
+        prefijo = (prefijo << 8) | (unsigned char) llave[i];
+        i++;
+    }
+    if (i > 0 && i < 8) {
+        prefijo <<= 8 * (8 - i); //rellenar con ceros lo que falta
     }
-    return copia;
+    return prefijo;
 }
 
-//funciones del heap alfabético
-
-/*intercambia dos nodos del heap alfabético
-E: punteros a los nodos a intercambiar
-S: void
-R: que los punteros no sean NULL
+/*compara dos nodos: primero los prefijos como enteros y solo si empatan se usa strcmp
+con el resto de la llave
+E: heap (por el desplazamiento), punteros a los nodos
+S: negativo si a < b, 0 si son iguales, positivo si a > b
+R: que los prefijos esten calculados con el desplazamiento actual del heap
 */
-static void intercambiar_nodos_alfabetico(struct nodo_heap_alfabetico* a    , struct nodo_heap_alfabetico* b) {
-    struct nodo_heap_alfabetico temp = *a;
-    *a = *b;
-    *b = temp;
+static inline int comparar_nodos_alfabetico(const struct heap_alfabetico* heap,
+                                            const struct nodo_heap_alfabetico* a,
+                                            const struct nodo_heap_alfabetico* b) {
+    if (a->prefijo != b->prefijo) {
+        return (a->prefijo < b->prefijo) ? -1 : 1;
+    }
+    //si el ultimo byte del prefijo es 0 las dos llaves terminaron dentro del prefijo: son iguales
+    if ((a->prefijo & 0xFF) == 0) {
+        return 0;
+    }
+    return strcmp(a->llave + heap->desplazamiento + 8, b->llave + heap->desplazamiento + 8);
 }
 
-/*asegura que siempre haya espacio en el heap para agregar un nodo mas en caso de que se llegue a llenar el heap
-E: puntero al heap alfabético
-S: void
-R: que exista el heap, que tenga capacidad mayor a 0
+/*largo del prefijo que comparten dos cadenas
+E: dos cadenas, maximo a revisar
+S: cantidad de bytes iguales al inicio
+R: que no sean NULL
 */
-static void asegurar_capacidad_alfabetico(struct heap_alfabetico* heap) {
-    if (heap->tamano < heap->capacidad) return;
-
-    int nueva_capacidad = heap->capacidad * 2;
-    if (nueva_capacidad <= 0){
-        fprintf(stderr, "Advertencia: capacidad del heap alfabetico excede el limite.\n");
-        nueva_capacidad = 1;
-    }
-    struct nodo_heap_alfabetico* nuevo =
-        (struct nodo_heap_alfabetico*) realloc(
-            heap->nodos,
-            nueva_capacidad * sizeof(struct nodo_heap_alfabetico)
-        );
-
-    if (nuevo == NULL) {
-        fprintf(stderr, "Error: no se pudo redimensionar heap alfabetico.\n");
-        return;
+static size_t prefijo_comun(const char* a, const char* b, size_t maximo) {
+    size_t i = 0;
+    while (i < maximo && a[i] != '\0' && a[i] == b[i]) {
+        i++;
     }
-
-    heap->nodos = nuevo;
-    heap->capacidad = nueva_capacidad;
+    return i;
 }
 
-/*intercambia un nodo hijo con su padre si el nodo hijo es menor alfabéticamente que el padre
-E: heap y el indice del nodo a mover hacia arriba
+/*recalcula el prefijo de cada nodo con el desplazamiento actual del heap
+E: heap
 S: void
-R: que el heap exista, asegurarse que el indice sea valido
+R: que el heap exista
 */
-static void subir_alfabetico(struct heap_alfabetico* heap, int idx) {
-    while (idx > 0) {
-        int padre = (idx - 1) / 2;
-        if (strcmp(heap->nodos[idx].llave, heap->nodos[padre].llave) < 0) {
-            intercambiar_nodos_alfabetico(&heap->nodos[idx], &heap->nodos[padre]);
-            idx = padre;
-        } else {
-            break;
-        }
+static void recalcular_prefijos(struct heap_alfabetico* heap) {
+    for (int i = 0; i < heap->tamano; i++) {
+        heap->nodos[i].prefijo = calcular_prefijo(heap->nodos[i].llave + heap->desplazamiento);
     }
 }
 
-/*mueve un nodo hacia abajo en el heap para mantener la propiedad del min heap
-E: el heap y el indice del nodo padre a mover hacia abajo
-S: void
-R: que el heap exista, asegurarse que el indice sea valido
+/*el nodo con la llave menor va primero (prefijo como entero y, si empata, el resto con strcmp);
+con llaves iguales el de indice menor, asi el orden es estable y al mezclar las corridas de varios
+hilos sale lo mismo que con uno solo
+E: heap, dos nodos
+S: 1 si a va antes que b
+R: ninguna
 */
-static void bajar_alfabetico(struct heap_alfabetico* heap, int idx) {
-    int izquierda, derecha, menor;
+static inline int menor_alfabetico(const struct heap_alfabetico* heap,
+                                   const struct nodo_heap_alfabetico* a,
+                                   const struct nodo_heap_alfabetico* b) {
+    int comparacion = comparar_nodos_alfabetico(heap, a, b);
+    return comparacion < 0 || (comparacion == 0 && a->indice < b->indice);
+}
 
-    while (1) {
-        izquierda = 2 * idx + 1;
-        derecha = 2 * idx + 2;
-        menor = idx;
+#define MENOR_ALFABETICO(heap, a, b) menor_alfabetico((heap), (a), (b))
 
-        if (izquierda < heap->tamano &&
-            strcmp(heap->nodos[izquierda].llave, heap->nodos[menor].llave) < 0) {
-            menor = izquierda;
-        }
-        if (derecha < heap->tamano &&
-            strcmp(heap->nodos[derecha].llave, heap->nodos[menor].llave) < 0) {
-            menor = derecha;
-        }
-        if (menor != idx) {
-            intercambiar_nodos_alfabetico(&heap->nodos[idx], &heap->nodos[menor]);
-            idx = menor;
-        } else {
-            break;
-        }
-    }
-}
+DEFINIR_HEAP(alfabetico, struct heap_alfabetico, struct nodo_heap_alfabetico, MENOR_ALFABETICO)
+
+//funciones del heap alfabético
 
 /*crea un heap alfabético
 E: capacidad inicial del heap
@@ -129,6 +107,9 @@ struct heap_alfabetico* crear_heap_alfabetico(int capacidad_inicial) {
 
     heap->tamano = 0;
     heap->capacidad = capacidad_inicial;
+    heap->aridad = aridad_heaps();
+    heap->desplazamiento = 0;
+    heap->referencia = NULL;
     return heap;
 }
 
@@ -141,58 +122,93 @@ int heap_alfabetico_vacio(struct heap_alfabetico* heap) {
     return (heap == NULL || heap->tamano == 0);
 }
 
-/*inserta un articulo en el heap alfabético
-E: puntero al heap, articulo a insertar, llave alfabética
+/*inserta el indice de un articulo en el heap alfabético
+E: puntero al heap, indice del articulo a insertar, llave alfabética
 S: void
 R: que el heap exista, que la llave no sea NULL
 */
-void insertar_heap_alfabetico(struct heap_alfabetico *heap, struct articulo articulo, const char *llave) {
+void insertar_heap_alfabetico(struct heap_alfabetico *heap, uint32_t indice, const char *llave) {
     //validaciones
     if (heap == NULL || llave == NULL) return;
 
-    asegurar_capacidad_alfabetico(heap);
+    if (!asegurar_capacidad_alfabetico(heap)) return;
+
+    //si la llave nueva no comparte el prefijo que se esta saltando, se achica el desplazamiento
+    //y se rehace el heap (solo pasa si las llaves cambian de forma, no en el uso normal)
+    if (heap->referencia == NULL) {
+        heap->referencia = llave;
+    } else if (heap->desplazamiento > 0) {
+        size_t comun = prefijo_comun(llave, heap->referencia, heap->desplazamiento);
+        if (comun < heap->desplazamiento) {
+            heap->desplazamiento = comun;
+            recalcular_prefijos(heap);
+            heapificar_alfabetico(heap);
+        }
+    }
 
     int idx = heap->tamano;
 
-    //copiar el articulo por valor
-    heap->nodos[idx].articulo = articulo;
-
-    //guardar copia de la llave
-    heap->nodos[idx].llave = copiar_llave_alfabetica(llave);
+    //solo se guarda la posicion del articulo y la llave prestada (no se copia)
+    heap->nodos[idx].indice = indice;
+    heap->nodos[idx].llave = llave;
+    heap->nodos[idx].prefijo = calcular_prefijo(llave + heap->desplazamiento);
 
     heap->tamano++;
 
     subir_alfabetico(heap, idx);
 }
 
-/*extrae el articulo con la llave alfabética mínima del heap
-E: puntero al heap alfabético
-S: articulo con la llave alfabética mínima
-R: que el heap exista y no este vacio
+/*agrega un nodo al final del heap alfabético sin acomodarlo (ver construir_heap_alfabetico)
+E: puntero al heap, indice del articulo, llave alfabética
+S: void
+R: que el heap exista, que la llave no sea NULL
 */
-struct articulo extraer_min_heap_alfabetico(struct heap_alfabetico* heap) {
-    //artículo vacío por si algo sale mal
-    struct articulo vacio = {NULL, NULL, NULL, NULL, 0, NULL};
+void agregar_sin_ordenar_heap_alfabetico(struct heap_alfabetico *heap, uint32_t indice, const char *llave) {
+    if (heap == NULL || llave == NULL) return;
 
-    //validaciones
-    if (heap == NULL || heap->tamano == 0) {
-        return vacio;
-    }
+    if (!asegurar_capacidad_alfabetico(heap)) return;
+    heap->nodos[heap->tamano].indice = indice;
+    heap->nodos[heap->tamano].llave = llave; //el prefijo se calcula en construir_heap_alfabetico
+    heap->tamano++;
+}
 
-    // guardar el nodo mínimo para devolverlo
-    struct nodo_heap_alfabetico min_nodo = heap->nodos[0];
+/*construye el heap alfabético con el metodo de Floyd (de abajo hacia arriba), O(n)
+antes busca el prefijo que comparten todas las llaves (por ejemplo "/repo/" en las rutas)
+para saltarselo y que los 8 bytes del prefijo de cada nodo sirvan para distinguirlas
+E: puntero al heap con nodos agregados sin ordenar
+S: void
+R: que el heap exista
+*/
+void construir_heap_alfabetico(struct heap_alfabetico* heap) {
+    if (heap == NULL || heap->tamano == 0) return;
 
-    //se reemplaza la raíz con el último nodo y se reduce el tamaño
-    heap->tamano--;
-    if (heap->tamano > 0) {
-        heap->nodos[0] = heap->nodos[heap->tamano];
-        bajar_alfabetico(heap, 0);
+    const char* referencia = heap->nodos[0].llave;
+    size_t comun = strlen(referencia);
+    for (int i = 1; i < heap->tamano && comun > 0; i++) {
+        comun = prefijo_comun(heap->nodos[i].llave, referencia, comun);
     }
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+    heap->referencia = referencia;
+    heap->desplazamiento = comun;
+    recalcular_prefijos(heap);
+    heapificar_alfabetico(heap);
+    terminar_fase(FASE_CONSTRUCCION, &marca);
+}
 
-    //se libera la memoria de la llave del nodo mínimo
-    free(min_nodo.llave);
+/*extrae el indice del articulo con la llave alfabética mínima del heap
+E: puntero al heap alfabético
+S: indice del articulo con la llave alfabética mínima, INDICE_INVALIDO si falla
+R: que el heap exista y no este vacio
+*/
+uint32_t extraer_min_heap_alfabetico(struct heap_alfabetico* heap) {
+    //validaciones
+    if (heap == NULL || heap->tamano == 0) {
+        return INDICE_INVALIDO;
+    }
 
-    return min_nodo.articulo;
+    //se reemplaza la raíz con el último nodo y se baja
+    return sacar_raiz_alfabetico(heap);
 }
 
 /*destruye el heap alfabético y libera la memoria
@@ -204,95 +220,114 @@ void destruir_heap_alfabetico(struct heap_alfabetico* heap) {
     //validacion
     if (heap == NULL) return;
 
-    //liberar la memoria de las llaves y el arreglo de nodos
-    for (int i = 0; i < heap->tamano; i++) {
-        free(heap->nodos[i].llave);
-    }
-
+    //las llaves son prestadas, solo se libera el arreglo de nodos
     free(heap->nodos);
     free(heap);
 }
 
 //Funciones de ordenamiento alfabético
 
-/*ordena un arreglo de artículos por título alfabéticamente (A-Z)
-E: articulos (arreglo de artículos), n = cantidad de artículos
-S: nuevo arreglo con artículos ordenados por título
-R: que el arreglo exista y hayan artículos
+/*ordena un arreglo de llaves alfabéticas con el heap (heapify + k extracciones)
+E: llaves (llave de cada artículo), n, k
+S: arreglo con los indices de las k llaves menores en orden, NULL si falla
+R: que 1 <= k <= n, que las llaves no sean NULL
 */
-struct articulo* ordenar_por_titulo(struct articulo* articulos, int n) {
-    //Validar
-    if (articulos == NULL || n <= 0) {
+uint32_t* ordenar_llaves_alfabeticas_k(const char* const* llaves, int n, int k) {
+    if (llaves == NULL || n <= 0 || k <= 0 || k > n) {
         return NULL;
     }
 
     //crear heap alfabético
     struct heap_alfabetico* heap = crear_heap_alfabetico(n); // capacidad inicial = n
     if (heap == NULL) {
-        fprintf(stderr, "Error: no se pudo crear heap para ordenar por titulo.\n");
+        fprintf(stderr, "Error: no se pudo crear heap para ordenar.\n");
         return NULL;
     }
 
-    //insertar todos los artículos usando el título como llave
+    //agregar todas las llaves y construir el heap de una vez
     for (int i = 0; i < n; i++) {
-        insertar_heap_alfabetico(heap, articulos[i], articulos[i].titulo_articulo);
+        agregar_sin_ordenar_heap_alfabetico(heap, (uint32_t) i, llaves[i]);
     }
+    construir_heap_alfabetico(heap);
 
-    //crear arreglo para artículos ordenados
-    struct articulo* ordenados = calloc(n, sizeof(struct articulo));
+    //crear arreglo para los indices ordenados
+    uint32_t* ordenados = calloc(k, sizeof(uint32_t));
     if (ordenados == NULL) {
         fprintf(stderr, "Error: no se pudo asignar memoria para array ordenado.\n");
         destruir_heap_alfabetico(heap);
         return NULL;
     }
 
-    //extraer artículos del heap que salen ya ordenados alfabéticamente
-    for (int i = 0; i < n; i++) {
-        ordenados[i] = extraer_min_heap_alfabetico(heap);
-    }
+    //extraer solo los primeros k artículos del heap, que salen ya ordenados alfabéticamente
+    extraer_k_alfabetico(heap, ordenados, k);
 
     //destruir el heap y retornar
     destruir_heap_alfabetico(heap);
     return ordenados;
 }
 
-/*ordena un arreglo de artículos por nombre de archivo (ruta) alfabéticamente
-E: articulos (arreglo de artículos), n = cantidad de artículos
-S: nuevo arreglo con artículos ordenados por ruta
-R: que el arreglo exista y hayan artículos
+/*ordena por un criterio alfabético usando la llave de colacion de cada artículo,
+que se calcula una sola vez aca y no en cada comparacion
+E: articulos, n, k, criterio (CRITERIO_TITULO o CRITERIO_RUTA)
+S: arreglo con los indices de los primeros k artículos, NULL si falla
+R: que el arreglo exista y que 1 <= k <= n
 */
-struct articulo* ordenar_por_nombre_archivo(struct articulo* articulos, int n) {
-    //validar 
-    if (articulos == NULL || n <= 0) {
+static uint32_t* ordenar_por_colacion_k(struct articulo* articulos, int n, int k, enum criterio_orden criterio) {
+    if (articulos == NULL || n <= 0 || k <= 0 || k > n) {
         return NULL;
     }
 
-    //crear heap alfabético
-    struct heap_alfabetico* heap = crear_heap_alfabetico(n);
-    if (heap == NULL) {
-        fprintf(stderr, "Error: no se pudo crear heap para ordenar por archivo.\n");
+    const char** llaves = malloc(n * sizeof(const char*));
+    if (llaves == NULL) {
+        fprintf(stderr, "Error: no se pudo asignar memoria para las llaves.\n");
         return NULL;
     }
 
-    //insertar todos los artículos usando la RUTA como llave
-    for (int i = 0; i < n; i++) {
-        insertar_heap_alfabetico(heap, articulos[i], articulos[i].ruta);
-    }
-
-    //crear arreglo para artículos ordenados
-    struct articulo* ordenados = calloc(n, sizeof(struct articulo));
-    if (ordenados == NULL) {
-        fprintf(stderr, "Error: no se pudo asignar memoria para array ordenado.\n");
-        destruir_heap_alfabetico(heap);
-        return NULL;
-    }
+    struct arena arena;
+    iniciar_arena(&arena, 0);
 
-    //extraer artículos del heap (saldrán ordenados por su ruta)
-    for (int i = 0; i < n; i++) {
-        ordenados[i] = extraer_min_heap_alfabetico(heap);
+    uint32_t* ordenados = NULL;
+    if (llenar_llaves_alfabeticas(articulos, n, criterio, &arena, llaves)) {
+        ordenados = ordenar_llaves_alfabeticas_k(llaves, n, k);
     }
 
-    //destruir el heap y retornar
-    destruir_heap_alfabetico(heap);
+    liberar_arena(&arena);
+    free(llaves);
     return ordenados;
-}
\ No newline at end of file
+}
+
+/*ordena un arreglo de artículos por título alfabéticamente (A-Z, sin importar mayusculas ni tildes)
+E: articulos (arreglo de artículos), n = cantidad de artículos, k = cuantos extraer
+S: nuevo arreglo con los indices de los primeros k artículos ordenados por título
+R: que el arreglo exista y que 1 <= k <= n
+*/
+uint32_t* ordenar_por_titulo_k(struct articulo* articulos, int n, int k) {
+    return ordenar_por_colacion_k(articulos, n, k, CRITERIO_TITULO);
+}
+
+/*ordena un arreglo de artículos por título alfabéticamente (A-Z)
+E: articulos (arreglo de artículos), n = cantidad de artículos
+S: nuevo arreglo con los indices de los artículos ordenados por título
+R: que el arreglo exista y hayan artículos
+*/
+uint32_t* ordenar_por_titulo(struct articulo* articulos, int n) {
+    return ordenar_por_titulo_k(articulos, n, n);
+}
+
+/*ordena un arreglo de artículos por nombre de archivo (ruta) alfabéticamente
+E: articulos (arreglo de artículos), n = cantidad de artículos, k = cuantos extraer
+S: nuevo arreglo con los indices de los primeros k artículos ordenados por ruta
+R: que el arreglo exista y que 1 <= k <= n
+*/
+uint32_t* ordenar_por_nombre_archivo_k(struct articulo* articulos, int n, int k) {
+    return ordenar_por_colacion_k(articulos, n, k, CRITERIO_RUTA);
+}
+
+/*ordena un arreglo de artículos por nombre de archivo (ruta) alfabéticamente
+E: articulos (arreglo de artículos), n = cantidad de artículos
+S: nuevo arreglo con los indices de los artículos ordenados por ruta
+R: que el arreglo exista y hayan artículos
+*/
+uint32_t* ordenar_por_nombre_archivo(struct articulo* articulos, int n) {
+    return ordenar_por_nombre_archivo_k(articulos, n, n);
+}
@@ -0,0 +1,124 @@
+#ifndef HEAP_GENERICO_H
+#define HEAP_GENERICO_H
+
+#include "heap.h"
+#include <stdio.h>   // fprintf
+#include <stdlib.h>  // realloc
+
+//NUCLEO DE LOS HEAPS: las operaciones de un min-heap d-ario escritas una sola vez y generadas para cada
+//tipo de nodo con DEFINIR_HEAP, asi la comparacion y el movimiento de nodos quedan en linea dentro de
+//cada ciclo en vez de pasar por una funcion generica (heap_numerico.c y heap_alfabético.c las usan).
+//
+//el tipo del heap tiene que tener los campos nodos, tamano, capacidad y aridad, y cada nodo un campo
+//indice; MENOR(heap, a, b) recibe punteros a dos nodos y da 1 si a va antes que b.
+//subir y bajar mueven el nodo como un hueco (cada nivel es una copia, no un intercambio) y no revisan
+//los indices: quien llama garantiza que son validos
+#define DEFINIR_HEAP(sufijo, tipo_heap, tipo_nodo, MENOR)                                            \
+                                                                                                     \
+/*sube un nodo mientras sea menor que su padre                                                       \
+E: heap, posicion del nodo                                                                           \
+S: void                                                                                              \
+R: que 0 <= hijo < tamano                                                                            \
+*/                                                                                                   \
+static inline void subir_##sufijo(tipo_heap* heap, int hijo) {                                       \
+    tipo_nodo nodo = heap->nodos[hijo];                                                              \
+    while (hijo > 0) {                                                                               \
+        int padre = (hijo - 1) / heap->aridad;                                                       \
+        CONTAR(comparaciones);                                                                       \
+        if (!MENOR(heap, &nodo, &heap->nodos[padre])) break;                                         \
+        CONTAR(intercambios);                                                                        \
+        heap->nodos[hijo] = heap->nodos[padre];                                                      \
+        hijo = padre;                                                                                \
+    }                                                                                                \
+    heap->nodos[hijo] = nodo;                                                                        \
+}                                                                                                    \
+                                                                                                     \
+/*baja un nodo mientras alguno de sus hijos sea menor (los hijos de p estan seguidos desde d*p + 1)  \
+E: heap, posicion del nodo                                                                           \
+S: void                                                                                              \
+R: que 0 <= padre < tamano                                                                           \
+*/                                                                                                   \
+static inline void bajar_##sufijo(tipo_heap* heap, int padre) {                                      \
+    tipo_nodo nodo = heap->nodos[padre];                                                             \
+    const int aridad = heap->aridad;                                                                 \
+    const int tamano = heap->tamano;                                                                 \
+    while (1) {                                                                                      \
+        int primero = aridad * padre + 1;                                                            \
+        if (primero >= tamano) break;                                                                \
+        int ultimo = (primero + aridad < tamano) ? primero + aridad : tamano;                        \
+                                                                                                     \
+        int menor = primero;                                                                         \
+        for (int hijo = primero + 1; hijo < ultimo; hijo++) {                                        \
+            CONTAR(comparaciones);                                                                   \
+            if (MENOR(heap, &heap->nodos[hijo], &heap->nodos[menor])) menor = hijo;                  \
+        }                                                                                            \
+        CONTAR(comparaciones);                                                                       \
+        if (!MENOR(heap, &heap->nodos[menor], &nodo)) break;                                         \
+        CONTAR(intercambios);                                                                        \
+        heap->nodos[padre] = heap->nodos[menor];                                                     \
+        padre = menor;                                                                               \
+    }                                                                                                \
+    heap->nodos[padre] = nodo;                                                                       \
+}                                                                                                    \
+                                                                                                     \
+/*acomoda todo el arreglo como heap bajando cada padre desde el ultimo (metodo de Floyd), O(n)       \
+E: heap                                                                                              \
+S: void                                                                                              \
+R: que el heap exista                                                                                \
+*/                                                                                                   \
+static void heapificar_##sufijo(tipo_heap* heap) {                                                   \
+    if (heap->tamano < 2) return;                                                                    \
+    for (int padre = (heap->tamano - 2) / heap->aridad; padre >= 0; padre--) {                       \
+        bajar_##sufijo(heap, padre);                                                                 \
+    }                                                                                                \
+}                                                                                                    \
+                                                                                                     \
+/*saca la raiz: el ultimo nodo pasa a la raiz y se baja                                              \
+E: heap                                                                                              \
+S: indice del nodo minimo                                                                            \
+R: que el heap no este vacio                                                                         \
+*/                                                                                                   \
+static inline uint32_t sacar_raiz_##sufijo(tipo_heap* heap) {                                        \
+    uint32_t indice = heap->nodos[0].indice;                                                         \
+    heap->tamano--;                                                                                  \
+    if (heap->tamano > 0) {                                                                          \
+        heap->nodos[0] = heap->nodos[heap->tamano];                                                  \
+        bajar_##sufijo(heap, 0);                                                                     \
+    }                                                                                                \
+    return indice;                                                                                   \
+}                                                                                                    \
+                                                                                                     \
+/*duplica la capacidad del heap si esta lleno                                                        \
+E: heap                                                                                              \
+S: 1 si hay lugar para un nodo mas, 0 si no hubo memoria                                             \
+R: que el heap exista                                                                                \
+*/                                                                                                   \
+static int asegurar_capacidad_##sufijo(tipo_heap* heap) {                                            \
+    if (heap->tamano < heap->capacidad) return 1;                                                    \
+    int nueva_capacidad = (heap->capacidad > 0) ? heap->capacidad * 2 : 1;                           \
+    CONTAR(realocaciones);                                                                           \
+    tipo_nodo* nuevo = realloc(heap->nodos, (size_t) nueva_capacidad * sizeof(tipo_nodo));           \
+    if (nuevo == NULL) {                                                                             \
+        fprintf(stderr, "Error: no se pudo redimensionar el heap.\n");                               \
+        return 0;                                                                                    \
+    }                                                                                                \
+    heap->nodos = nuevo;                                                                             \
+    heap->capacidad = nueva_capacidad;                                                               \
+    return 1;                                                                                        \
+}                                                                                                    \
+                                                                                                     \
+/*saca los k menores en orden (heapsort parcial): el heap ya tiene que estar construido              \
+E: heap, destino (k indices), k                                                                      \
+S: void                                                                                              \
+R: que k <= tamano                                                                                   \
+*/                                                                                                   \
+static void extraer_k_##sufijo(tipo_heap* heap, uint32_t* destino, int k) {                          \
+    struct marca_tiempo marca;                                                                       \
+    iniciar_fase(&marca);                                                                            \
+    for (int i = 0; i < k; i++) {                                                                    \
+        destino[i] = sacar_raiz_##sufijo(heap);                                                      \
+    }                                                                                                \
+    terminar_fase(FASE_EXTRACCION, &marca);                                                          \
+}
+
+#endif
@@ -1,118 +1,14 @@
 #include "heap.h"
-#include <stdio.h>   // fprintf
-#include <stdlib.h>  // malloc, free, realloc
-#include <string.h>  // strcmp, strlen, memcpy
+#include "heap_generico.h"
+#include <stdio.h>   // printf
+#include <stdlib.h>  // malloc, free
 
-/*
-E: puntero al heap , indices de los nodos a intercambiar
-S: void
-R: el heap debe existir, los indices deben ser validos
-*/
-static void intercambiar_nodos_numerico(struct heap_numerico* heap, int i, int j) {
-    
-    //validaciones
-    if (heap == NULL || i < 0 || j < 0 || i >= heap->tamano || j >= heap->tamano) {
-        printf("Error: no se pudo intercambiar nodos numericos, indices invalidos.\n");
-        return;
-    }
-    
-    struct nodo_heap_numerico temp = heap->nodos[i];
-    heap->nodos[i] = heap->nodos[j];
-    heap->nodos[j] = temp;
-}
-
-/*
-Asegura que siempre haya espacio en el heap para agregar un nodo mas en caso de que se llegue a llenar el heap
-E: puntero al heap numérico
-S: void
-R: que exista el heap, que tenga capacidad mayor a 0
-*/
-static void asegurar_capacidad_numerico(struct heap_numerico* heap) {
-    
-    //validacion: que exista el heap
-    if (heap == NULL){
-        return;
-    }
-
-    //si aun hay campo, no se ocupa
-    if (heap->tamano < heap->capacidad) {
-        return;
-    }
-
-    //duplica la capacidad del heap
-    int nueva_capacidad = heap->capacidad * 2; 
-    
-    //validacion por si la nueva capacidad llega a ser inutil (no deberia suceder)
-    if (nueva_capacidad <= 0){
-        nueva_capacidad = 1;
-    }
-
-    //expande en donde ya esta
-    struct nodo_heap_numerico* nuevo = realloc(heap->nodos, nueva_capacidad * sizeof(struct nodo_heap_numerico));
-
-    if (nuevo == NULL) {
-        printf("Error: no se pudo redimensionar heap numerico.\n");
-        return;
-    }
-
-    //actualiza el heap
-    heap->nodos = nuevo;
-    heap->capacidad = nueva_capacidad;
-}
-
-/*
-Intercambia un nodo hijo con su padre si el nodo hijo es menor que el padre
-E: heap y el indice del nodo a mover hacia arriba
-S: void
-R: que el heap exista, asegurarse que el indice sea valido
-*/
-static void subir_numerico(struct heap_numerico* heap, int hijo) {
-    while (hijo > 0) {
-        int padre = (hijo - 1) / 2; //formula para encontrar al padre
-
-        //asegurarse que el indice del nodo del papa sea menor que el del hijo
-        //si el numero de palabras o año es menor, se intercambian
-        if (heap->nodos[hijo].llave < heap->nodos[padre].llave) {
-            intercambiar_nodos_numerico(heap, hijo, padre);
-            hijo = padre;
-        } else {
-            break;
-        }
-    }
-};
-
-/*
-E: el heap  y el indice del nodo padre a mover hacia abajo
-S: void
-R: que el heap exista, asegurarse que el indice sea valido
-*/
-static void bajar_numerico(struct heap_numerico* heap, int padre) {
-    int izquierda, derecha, menor;
-
-    while (1) { //para que se haga infinitamente (hasta que haya un break)
-        
-        //formulas para llegar a hijos
-        izquierda = 2 * padre + 1;
-        derecha = 2 * padre + 2;
-        menor = padre;
-
-        //verificar que de ese lado existan hijos y comparar llaves
-        if (izquierda < heap->tamano && heap->nodos[izquierda].llave < heap->nodos[menor].llave) {
-            menor = izquierda;
-        }
-        if (derecha < heap->tamano && heap->nodos[derecha].llave < heap->nodos[menor].llave) {
-            menor = derecha;
-        }
+//el nodo con la llave menor va primero; con llaves iguales el de indice menor, asi el resultado no
+//depende de la forma del heap (es el mismo con cualquier aridad y al mezclar corridas de varios hilos)
+#define MENOR_NUMERICO(heap, a, b) \
+    ((a)->llave < (b)->llave || ((a)->llave == (b)->llave && (a)->indice < (b)->indice))
 
-        //para que no se intente de intercambiar con si mismo en caso de que el padre sea menor
-        if (menor != padre) { 
-            intercambiar_nodos_numerico(heap, padre, menor);
-            padre = menor;
-        } else { 
-            break;
-        }
-    }
-}
+DEFINIR_HEAP(numerico, struct heap_numerico, struct nodo_heap_numerico, MENOR_NUMERICO)
 
 /*
 E: capacidad inicial del heap
@@ -138,6 +34,7 @@ struct heap_numerico* crear_heap_numerico(int capacidad_inicial) {
 
     heap->tamano = 0; //inicia en 0 xq aun no tiene contenido
     heap->capacidad = capacidad_inicial;
+    heap->aridad = aridad_heaps();
     return heap;
 }
 
@@ -155,58 +52,75 @@ int heap_numerico_vacio(struct heap_numerico* heap) {
 }
 
 /*
-inserta un articulo en el heap
-E: puntero al heap, articulo a insertar, llave
+inserta el indice de un articulo en el heap
+E: puntero al heap, indice del articulo a insertar, llave
 S: void
 R: que el heap exista
 */
-void insertar_heap_numerico(struct heap_numerico* heap, struct articulo articulo, int llave) {
+void insertar_heap_numerico(struct heap_numerico* heap, uint32_t indice, int llave) {
     if (heap == NULL) {
         printf("Error: el heap no existe.\n");
         return;
     }
 
     //asegurar que haya espacio para un nodo mas
-    asegurar_capacidad_numerico(heap);
+    if (!asegurar_capacidad_numerico(heap)) return;
 
-    //insertar el nuevo nodo al final
-    heap->nodos[heap->tamano].articulo = articulo;
-    heap->nodos[heap->tamano].llave = llave;
+    //insertar el nuevo nodo al final y subirlo para mantener la propiedad del heap
+    heap->nodos[heap->tamano] = (struct nodo_heap_numerico) {llave, indice};
+    heap->tamano++;
+    subir_numerico(heap, heap->tamano - 1);
+}
 
-    heap->tamano++; //el heap incrementa con un nodo mas
+/*
+agrega un nodo al final del heap sin acomodarlo, para construir el heap de una sola vez despues
+E: puntero al heap, indice del articulo, llave
+S: void
+R: que el heap exista, llamar construir_heap_numerico antes de extraer
+*/
+void agregar_sin_ordenar_heap_numerico(struct heap_numerico* heap, uint32_t indice, int llave) {
+    if (heap == NULL) {
+        printf("Error: el heap no existe.\n");
+        return;
+    }
 
-    //ver si subir el nodo para mantener la propiedad del heap
-    subir_numerico(heap, heap->tamano - 1);
+    if (!asegurar_capacidad_numerico(heap)) return;
+    heap->nodos[heap->tamano] = (struct nodo_heap_numerico) {llave, indice};
+    heap->tamano++;
+}
+
+/*
+construye el heap con el metodo de Floyd: baja cada padre empezando por el ultimo, O(n) en total
+E: puntero al heap con nodos agregados sin ordenar
+S: void
+R: que el heap exista
+*/
+void construir_heap_numerico(struct heap_numerico* heap) {
+    if (heap == NULL || heap->tamano < 2) {
+        return;
+    }
+
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+    heapificar_numerico(heap);
+    terminar_fase(FASE_CONSTRUCCION, &marca);
 }
 
 /*
-Extrae el articulo con la llave minima del heap
+Extrae el indice del articulo con la llave minima del heap
 E: puntero al heap
-S: articulo con la llave minima
+S: indice del articulo con la llave minima, INDICE_INVALIDO si falla
 R: que el heap exista y no este vacio
 */
-struct articulo extraer_min_heap_numerico(struct heap_numerico* heap) {
-    
-    //para retornar en caso de error
-    struct articulo art_vacio = {NULL, NULL, NULL, NULL, 0};
+uint32_t extraer_min_heap_numerico(struct heap_numerico* heap) {
     
     //validaciones
     if (heap == NULL || heap->tamano == 0) {
         printf("Error: no se puede extraer de un heap vacio o inexistente.\n");
-        return art_vacio;
+        return INDICE_INVALIDO;
     }
 
-    struct nodo_heap_numerico min_nodo = heap->nodos[0]; //el nodo con la llave minima esta en la raiz
-
-    heap->tamano--; //disminuye el tamaño del heap
-
-    //si aun hay nodos, mover el ultimo a la raiz y bajar para mantener la propiedad del heap
-    if (heap->tamano > 0) {
-        heap->nodos[0] = heap->nodos[heap->tamano];
-        bajar_numerico(heap, 0);
-    }
-
-    return min_nodo.articulo;
+    return sacar_raiz_numerico(heap);
 }
 
 /*
@@ -230,41 +144,35 @@ void destruir_heap_numerico(struct heap_numerico* heap) {
 //Funciones de ordenamiento numérico
 
 /*
- Ordena un array de artículos por año (menor a mayor)
- E: articulos (arreglo de artículos), n = cantidad de artículos
- S: nuevo arreglo con artículos ordenados por año
- R: que el arreglo exista y hayan artículos
- */
-struct articulo* ordenar_por_ano(struct articulo* articulos, int n) {
-    //validar
-    if (articulos == NULL || n <= 0) {
-        return NULL;
-    }
-
+ordena con el heap numérico (heapify + k extracciones), sirve para cualquier rango de llaves
+E: llaves (llave de cada artículo), n, k
+S: arreglo con los indices de las k llaves menores en orden, NULL si falla
+R: que 1 <= k <= n
+*/
+static uint32_t* ordenar_con_heap_numerico(const int* llaves, int n, int k) {
     //crear heap numérico
     struct heap_numerico* heap = crear_heap_numerico(n);
     if (heap == NULL) {
-        printf("Error: no se pudo crear heap para ordenar por año.\n");
+        printf("Error: no se pudo crear heap para ordenar.\n");
         return NULL;
     }
 
-    //insertar todos los artículos usando el año como llave
+    //agregar todos los artículos y construir el heap de una vez
     for (int i = 0; i < n; i++) {
-        insertar_heap_numerico(heap, articulos[i], articulos[i].ano);
+        agregar_sin_ordenar_heap_numerico(heap, (uint32_t) i, llaves[i]);
     }
+    construir_heap_numerico(heap);
 
-    //crear arreglo para artículos ordenados
-    struct articulo* ordenados = calloc(n, sizeof(struct articulo));
+    //crear arreglo para los indices ordenados
+    uint32_t* ordenados = calloc(k, sizeof(uint32_t));
     if (ordenados == NULL) {
         printf("Error: no se pudo asignar memoria para arreglo ordenado.\n");
         destruir_heap_numerico(heap);
         return NULL;
     }
 
-    //extraer artículos del heap que salen ya ordenados por año
-    for (int i = 0; i < n; i++) {
-        ordenados[i] = extraer_min_heap_numerico(heap);
-    }
+    //extraer solo los primeros k artículos del heap, que salen ya ordenados
+    extraer_k_numerico(heap, ordenados, k);
 
     // destruir el heap y retornar los artículos ordenados
     destruir_heap_numerico(heap);
@@ -272,44 +180,164 @@ struct articulo* ordenar_por_ano(struct articulo* articulos, int n) {
 }
 
 /*
-Ordena un array de artículos por cantidad de palabras en el título (menor a mayor)
-E: articulos (arreglo de artículos), n = cantidad de artículos
-S: nuevo arreglo con artículos ordenados por cantidad de palabras
-R: que el arreglo exista y hayan artículos
- */
-struct articulo* ordenar_por_palabras_titulo(struct articulo* articulos, int n) {
-    //validar
-    if (articulos == NULL || n <= 0) {
+counting sort estable: cuenta cuantas veces sale cada llave, saca donde empieza cada una
+y acomoda los indices en una sola pasada, O(n + rango)
+E: llaves, n, k, minimo y rango (maximo - minimo + 1) de las llaves
+S: arreglo con los primeros k indices en orden (empates en el orden original), NULL si falla
+R: que todas las llaves esten entre minimo y minimo + rango - 1
+*/
+static uint32_t* ordenar_por_conteo(const int* llaves, int n, int k, int minimo, int rango) {
+    uint32_t* inicio = calloc(rango, sizeof(uint32_t));
+    uint32_t* ordenados = calloc(k, sizeof(uint32_t));
+    if (inicio == NULL || ordenados == NULL) {
+        printf("Error: no se pudo asignar memoria para el conteo.\n");
+        free(inicio);
+        free(ordenados);
         return NULL;
     }
 
-    // Crear heap numérico
-    struct heap_numerico* heap = crear_heap_numerico(n);
-    if (heap == NULL) {
-        printf("Error: no se pudo crear heap para ordenar por palabras.\n");
-        return NULL;
+    //el conteo completo se anota como construccion (no hay heap ni extracciones)
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+
+    //contar cada llave
+    for (int i = 0; i < n; i++) {
+        inicio[llaves[i] - minimo]++;
     }
 
-    //insertar todos los artículos usando la cantidad de palabras como llave
+    //convertir los conteos en la posicion donde empieza cada llave
+    uint32_t acumulado = 0;
+    for (int v = 0; v < rango; v++) {
+        uint32_t cantidad = inicio[v];
+        inicio[v] = acumulado;
+        acumulado += cantidad;
+    }
+
+    //acomodar los indices; los que caen despues de k no se guardan
     for (int i = 0; i < n; i++) {
-        int num_palabras = contar_palabras(articulos[i].titulo_articulo);
-        insertar_heap_numerico(heap, articulos[i], num_palabras);
+        uint32_t posicion = inicio[llaves[i] - minimo]++;
+        if (posicion < (uint32_t) k) {
+            ordenados[posicion] = (uint32_t) i;
+        }
     }
 
-    //crear arreglo para artículos ordenados
-    struct articulo* ordenados = calloc(n, sizeof(struct articulo));
-    if (ordenados == NULL) {
-        printf("Error: no se pudo asignar memoria para arreglo ordenado.\n");
-        destruir_heap_numerico(heap);
+    free(inicio);
+    terminar_fase(FASE_CONSTRUCCION, &marca);
+    return ordenados;
+}
+
+/*
+ordena llaves numéricas: si caben en un rango pequeño (años, palabras del título) usa counting sort,
+si no usa el heap
+E: llaves (llave de cada artículo), n, k
+S: arreglo con los indices de las k llaves menores en orden, NULL si falla
+R: que 1 <= k <= n
+*/
+uint32_t* ordenar_llaves_numericas_k(const int* llaves, int n, int k) {
+    if (llaves == NULL || n <= 0 || k <= 0 || k > n) {
         return NULL;
     }
 
-    //extraer artículos del heap que salen ya ordenados por cantidad de palabras
+    int minimo = llaves[0];
+    int maximo = llaves[0];
+    for (int i = 1; i < n; i++) {
+        if (llaves[i] < minimo) minimo = llaves[i];
+        if (llaves[i] > maximo) maximo = llaves[i];
+    }
+
+    //el rango se calcula en 64 bits por si las llaves son muy distintas
+    long long rango = (long long) maximo - minimo + 1;
+    if (rango <= RANGO_MAXIMO_CONTEO && rango <= (long long) n * 4) {
+        return ordenar_por_conteo(llaves, n, k, minimo, (int) rango);
+    }
+    return ordenar_con_heap_numerico(llaves, n, k);
+}
+
+/*
+llena un arreglo con la llave numérica de cada artículo segun el criterio
+E: articulos, n, criterio (CRITERIO_ANO o CRITERIO_PALABRAS), destino (n enteros)
+S: void
+R: que el criterio sea numérico
+*/
+void llenar_llaves_numericas(const struct articulo* articulos, int n, enum criterio_orden criterio, int* destino) {
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
     for (int i = 0; i < n; i++) {
-        ordenados[i] = extraer_min_heap_numerico(heap);
+        if (criterio == CRITERIO_ANO) {
+            destino[i] = articulos[i].ano;
+        } else {
+            destino[i] = contar_palabras(articulos[i].titulo_articulo);
+        }
     }
+    terminar_fase(FASE_LLAVES, &marca);
+}
 
-    //destruir el heap y retornar los artículos ordenados
-    destruir_heap_numerico(heap);
+/*
+ Ordena un array de artículos por año (menor a mayor)
+ E: articulos (arreglo de artículos), n = cantidad de artículos, k = cuantos extraer
+ S: nuevo arreglo con los indices de los primeros k artículos ordenados por año
+ R: que el arreglo exista y que 1 <= k <= n
+ */
+uint32_t* ordenar_por_ano_k(struct articulo* articulos, int n, int k) {
+    //validar
+    if (articulos == NULL || n <= 0 || k <= 0 || k > n) {
+        return NULL;
+    }
+
+    //sacar el año de cada artículo a un arreglo compacto
+    int* llaves = malloc(n * sizeof(int));
+    if (llaves == NULL) {
+        printf("Error: no se pudo asignar memoria para ordenar por año.\n");
+        return NULL;
+    }
+    llenar_llaves_numericas(articulos, n, CRITERIO_ANO, llaves);
+
+    uint32_t* ordenados = ordenar_llaves_numericas_k(llaves, n, k);
+    free(llaves);
     return ordenados;
-}
\ No newline at end of file
+}
+
+/*
+ Ordena un array de artículos por año (menor a mayor)
+ E: articulos (arreglo de artículos), n = cantidad de artículos
+ S: nuevo arreglo con los indices de los artículos ordenados por año
+ R: que el arreglo exista y hayan artículos
+ */
+uint32_t* ordenar_por_ano(struct articulo* articulos, int n) {
+    return ordenar_por_ano_k(articulos, n, n);
+}
+
+/*
+Ordena un array de artículos por cantidad de palabras en el título (menor a mayor)
+E: articulos (arreglo de artículos), n = cantidad de artículos, k = cuantos extraer
+S: nuevo arreglo con los indices de los primeros k artículos ordenados por cantidad de palabras
+R: que el arreglo exista y que 1 <= k <= n
+ */
+uint32_t* ordenar_por_palabras_titulo_k(struct articulo* articulos, int n, int k) {
+    //validar
+    if (articulos == NULL || n <= 0 || k <= 0 || k > n) {
+        return NULL;
+    }
+
+    //contar las palabras del título de cada artículo una sola vez
+    int* llaves = malloc(n * sizeof(int));
+    if (llaves == NULL) {
+        printf("Error: no se pudo asignar memoria para ordenar por palabras.\n");
+        return NULL;
+    }
+    llenar_llaves_numericas(articulos, n, CRITERIO_PALABRAS, llaves);
+
+    uint32_t* ordenados = ordenar_llaves_numericas_k(llaves, n, k);
+    free(llaves);
+    return ordenados;
+}
+
+/*
+Ordena un array de artículos por cantidad de palabras en el título (menor a mayor)
+E: articulos (arreglo de artículos), n = cantidad de artículos
+S: nuevo arreglo con los indices de los artículos ordenados por cantidad de palabras
+R: que el arreglo exista y hayan artículos
+ */
+uint32_t* ordenar_por_palabras_titulo(struct articulo* articulos, int n) {
+    return ordenar_por_palabras_titulo_k(articulos, n, n);
+}
@@ -0,0 +1,266 @@
+#include "../heap.h"
+#include "generacion.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// cuantos artículos pide el top-k del benchmark (lo tipico del menu)
+#define K_BENCHMARK 100
+
+static double ahora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+//tiempos de una fase en todas las repeticiones
+struct medicion {
+    double mejor;
+    double total;
+    int veces;
+};
+
+static void iniciar_medicion(struct medicion* medicion) {
+    medicion->mejor = 0.0;
+    medicion->total = 0.0;
+    medicion->veces = 0;
+}
+
+static void anotar(struct medicion* medicion, double segundos) {
+    if (medicion->veces == 0 || segundos < medicion->mejor) medicion->mejor = segundos;
+    medicion->total += segundos;
+    medicion->veces++;
+}
+
+static void reportar(int tamano, const char* fase, const struct medicion* medicion) {
+    printf("%10d  %-38s %10.4f %10.4f\n", tamano, fase, medicion->mejor,
+           medicion->total / (medicion->veces > 0 ? medicion->veces : 1));
+    fflush(stdout);
+}
+
+static void liberar_articulos(struct articulo* articulos, int total) {
+    for (int i = 0; i < total; i++) {
+        liberar_articulo(&articulos[i]);
+    }
+    free(articulos);
+}
+
+//una funcion de ordenamiento del heap.h con su nombre para el reporte
+struct ordenamiento {
+    const char* nombre;
+    uint32_t* (*completo)(struct articulo*, int);
+    uint32_t* (*top_k)(struct articulo*, int, int);
+};
+
+static const struct ordenamiento ordenamientos[] = {
+    {"ordenar_por_titulo", ordenar_por_titulo, ordenar_por_titulo_k},
+    {"ordenar_por_palabras_titulo", ordenar_por_palabras_titulo, ordenar_por_palabras_titulo_k},
+    {"ordenar_por_nombre_archivo", ordenar_por_nombre_archivo, ordenar_por_nombre_archivo_k},
+    {"ordenar_por_ano", ordenar_por_ano, ordenar_por_ano_k},
+};
+
+/*mide carga, cada ordenamiento y la salida para un archivo de un tamaño
+E: ruta del índice generado, tamaño (lineas), repeticiones
+S: 1 si salio bien, 0 si algo fallo
+R: que el archivo exista
+*/
+static int medir_tamano(const char* ruta, int tamano, int repeticiones) {
+    struct medicion medicion;
+    int total = 0;
+
+    // carga: getline, mmap y corpus con arena (este ultimo se queda para ordenar)
+    iniciar_medicion(&medicion);
+    for (int r = 0; r < repeticiones; r++) {
+        double inicio = ahora();
+        struct articulo* articulos = cargar_articulos(ruta, &total);
+        anotar(&medicion, ahora() - inicio);
+        if (articulos == NULL) return 0;
+        liberar_articulos(articulos, total);
+    }
+    reportar(tamano, "cargar_articulos", &medicion);
+
+    iniciar_medicion(&medicion);
+    for (int r = 0; r < repeticiones; r++) {
+        double inicio = ahora();
+        struct articulo* articulos = cargar_articulos_mmap(ruta, &total);
+        anotar(&medicion, ahora() - inicio);
+        if (articulos == NULL) return 0;
+        liberar_articulos(articulos, total);
+    }
+    reportar(tamano, "cargar_articulos_mmap", &medicion);
+
+    // la misma carga con cada version del escaner de delimitadores
+    static const char* escaneres[] = {"escalar", "sse2", "avx2"};
+    const char* escaner_original = escaner_actual();
+    char fase_escaner[64];
+    for (int e = 0; e < (int) (sizeof(escaneres) / sizeof(escaneres[0])); e++) {
+        if (!configurar_escaner(escaneres[e])) continue; // el procesador no la soporta
+        iniciar_medicion(&medicion);
+        for (int r = 0; r < repeticiones; r++) {
+            double inicio = ahora();
+            struct articulo* articulos = cargar_articulos_mmap(ruta, &total);
+            anotar(&medicion, ahora() - inicio);
+            if (articulos == NULL) return 0;
+            liberar_articulos(articulos, total);
+        }
+        snprintf(fase_escaner, sizeof(fase_escaner), "cargar_articulos_mmap (%s)", escaneres[e]);
+        reportar(tamano, fase_escaner, &medicion);
+    }
+    configurar_escaner(escaner_original);
+
+    struct corpus* corpus = NULL;
+    iniciar_medicion(&medicion);
+    for (int r = 0; r < repeticiones; r++) {
+        destruir_corpus(corpus);
+        double inicio = ahora();
+        corpus = cargar_corpus(ruta);
+        anotar(&medicion, ahora() - inicio);
+        if (corpus == NULL) return 0;
+    }
+    reportar(tamano, "cargar_corpus", &medicion);
+
+    // el conteo de palabras de todos los títulos (la columna derivada) con cada version
+    for (int e = 0; e < (int) (sizeof(escaneres) / sizeof(escaneres[0])); e++) {
+        if (!configurar_escaner(escaneres[e])) continue;
+        iniciar_medicion(&medicion);
+        for (int r = 0; r < repeticiones; r++) {
+            double inicio = ahora();
+            llenar_llaves_numericas(corpus->articulos, corpus->total, CRITERIO_PALABRAS,
+                                    corpus->columnas[COLUMNA_PALABRAS_TITULO]);
+            anotar(&medicion, ahora() - inicio);
+        }
+        snprintf(fase_escaner, sizeof(fase_escaner), "contar_palabras (%s)", escaneres[e]);
+        reportar(tamano, fase_escaner, &medicion);
+    }
+    configurar_escaner(escaner_original);
+
+    // ordenamientos completos y top-k
+    char fase[64];
+    uint32_t* por_ano = NULL;
+    for (int o = 0; o < (int) (sizeof(ordenamientos) / sizeof(ordenamientos[0])); o++) {
+        iniciar_medicion(&medicion);
+        for (int r = 0; r < repeticiones; r++) {
+            double inicio = ahora();
+            uint32_t* orden = ordenamientos[o].completo(corpus->articulos, corpus->total);
+            anotar(&medicion, ahora() - inicio);
+            if (ordenamientos[o].completo == ordenar_por_ano && por_ano == NULL) {
+                por_ano = orden; // se guarda para medir la salida
+            } else {
+                free(orden);
+            }
+        }
+        reportar(tamano, ordenamientos[o].nombre, &medicion);
+
+        int k = (corpus->total < K_BENCHMARK) ? corpus->total : K_BENCHMARK;
+        iniciar_medicion(&medicion);
+        for (int r = 0; r < repeticiones; r++) {
+            double inicio = ahora();
+            uint32_t* orden = ordenamientos[o].top_k(corpus->articulos, corpus->total, k);
+            anotar(&medicion, ahora() - inicio);
+            free(orden);
+        }
+        snprintf(fase, sizeof(fase), "%s_k (k=%d)", ordenamientos[o].nombre, k);
+        reportar(tamano, fase, &medicion);
+    }
+
+    // orden compuesto: una llave de bytes por artículo con todos los campos
+    struct orden_compuesto compuesto;
+    leer_orden_compuesto("ano:desc,autor,titulo", &compuesto);
+    iniciar_medicion(&medicion);
+    for (int r = 0; r < repeticiones; r++) {
+        double inicio = ahora();
+        uint32_t* orden = ordenar_compuesto_k(corpus, &compuesto, NULL, corpus->total, corpus->total);
+        anotar(&medicion, ahora() - inicio);
+        free(orden);
+    }
+    reportar(tamano, "ordenar_compuesto (ano:desc,autor,tit)", &medicion);
+
+    // salida de todo el corpus ordenado, a /dev/null para medir solo el formateo y las escrituras
+    static const char* formatos[] = {"humano", "tsv", "json", "rutas"};
+    int nulo = open("/dev/null", O_WRONLY);
+    int bien = (nulo >= 0 && por_ano != NULL);
+    for (int f = 0; bien && f < (int) (sizeof(formatos) / sizeof(formatos[0])); f++) {
+        enum formato_salida formato;
+        leer_formato(formatos[f], &formato);
+        iniciar_medicion(&medicion);
+        for (int r = 0; r < repeticiones; r++) {
+            double inicio = ahora();
+            bien = escribir_articulos(nulo, corpus->articulos, por_ano, corpus->total, "año", formato, CAMPOS_TODOS);
+            anotar(&medicion, ahora() - inicio);
+        }
+        snprintf(fase, sizeof(fase), "salida %s", formatos[f]);
+        reportar(tamano, fase, &medicion);
+    }
+
+    if (nulo >= 0) close(nulo);
+    free(por_ano);
+    destruir_corpus(corpus);
+    return bien;
+}
+
+/*mide carga, ordenamientos y salida sobre índices sintéticos de varios tamaños
+uso: benchmark [--semilla S] [--repeticiones R] [--aridad D] [--directorio DIR] [TAMANO ...]
+*/
+int main(int argc, char* argv[]) {
+    uint64_t semilla = SEMILLA_POR_DEFECTO;
+    int repeticiones = 3;
+    const char* directorio = "/tmp";
+    int tamanos[32];
+    int cantidad_tamanos = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            semilla = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--repeticiones") == 0 && i + 1 < argc) {
+            repeticiones = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--aridad") == 0 && i + 1 < argc) {
+            char* fin;
+            long aridad = strtol(argv[++i], &fin, 10);
+            if (fin == argv[i] || *fin != '\0' || aridad < 2 || aridad > ARIDAD_HEAP_MAXIMA) {
+                fprintf(stderr, "Aridad invalida: %s (entre 2 y %d)\n", argv[i], ARIDAD_HEAP_MAXIMA);
+                return 1;
+            }
+            configurar_aridad_heaps((int) aridad); // hijos por nodo de todos los heaps medidos
+        } else if (strcmp(argv[i], "--directorio") == 0 && i + 1 < argc) {
+            directorio = argv[++i];
+        } else if (argv[i][0] != '-' && atoi(argv[i]) > 0 && cantidad_tamanos < 32) {
+            tamanos[cantidad_tamanos++] = atoi(argv[i]);
+        } else {
+            fprintf(stderr, "Uso: %s [--semilla S] [--repeticiones R] [--aridad D] [--directorio DIR] [TAMANO ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (cantidad_tamanos == 0) {
+        tamanos[cantidad_tamanos++] = 10000;
+        tamanos[cantidad_tamanos++] = 100000;
+    }
+    if (repeticiones < 1) repeticiones = 1;
+
+    configurar_mensajes(0); // los cargadores no imprimen nada entre las mediciones
+
+    char ruta[4096];
+    snprintf(ruta, sizeof(ruta), "%s/benchmark_XXXXXX", directorio);
+    if (mkdtemp(ruta) == NULL) {
+        perror("No se pudo crear el directorio temporal");
+        return 1;
+    }
+    size_t largo_directorio = strlen(ruta);
+
+    printf("semilla=%llu repeticiones=%d aridad=%d escaner=%s\n", (unsigned long long) semilla, repeticiones,
+           aridad_heaps(), escaner_actual());
+    printf("%10s  %-38s %10s %10s\n", "tamano", "fase", "mejor (s)", "prom (s)");
+
+    int bien = 1;
+    for (int t = 0; bien && t < cantidad_tamanos; t++) {
+        snprintf(ruta + largo_directorio, sizeof(ruta) - largo_directorio, "/indice_%d.txt", tamanos[t]);
+        bien = generar_archivo(ruta, tamanos[t], semilla) && medir_tamano(ruta, tamanos[t], repeticiones);
+        unlink(ruta);
+    }
+
+    ruta[largo_directorio] = '\0';
+    rmdir(ruta);
+    return bien ? 0 : 1;
+}
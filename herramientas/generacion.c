@@ -0,0 +1,140 @@
+#include "generacion.h"
+#include <stdio.h>
+
+// años posibles: la mayoria de los artículos son recientes, con picos en algunos años
+#define ANO_MINIMO 1950
+#define ANO_MAXIMO 2024
+
+static const char* nombres[] = {
+    "Raimundo", "Andrés", "Claudio", "Frédéric", "María José", "Ángel", "Sofía", "Iñaki",
+    "Begoña", "José Luis", "Lucía", "Martín", "Valentina", "Sebastián", "Camila", "Nicolás",
+    "Mónica", "Héctor", "Ramón", "Inés", "Óscar", "Verónica", "Julián", "Noemí"
+};
+
+static const char* apellidos[] = {
+    "Soto", "Botero Bernal", "Nash Rojas", "Boehm", "Rodríguez Kauth", "Núñez", "Peña",
+    "García Márquez", "Muñoz", "Ibáñez", "Castañeda", "López", "Fernández de Córdoba",
+    "Zúñiga", "Ortúzar", "Álvarez", "Quiñones", "Saldaña", "Vargas Llosa", "Echeverría"
+};
+
+static const char* palabras[] = {
+    "corrupción", "política", "económica", "América", "Latina", "gobernabilidad", "ética",
+    "impunidad", "análisis", "institucional", "transparencia", "democracia", "Estado",
+    "crecimiento", "percepción", "sociedad", "colombiana", "peruana", "mexicana", "chilena",
+    "delincuencia", "organizada", "crímenes", "atroces", "revisión", "sistemática", "cultura",
+    "derechos", "humanos", "enfoque", "multidimensional", "perspectiva", "tensión", "jurídico",
+    "reforma", "contratación", "pública", "fiscalización", "rendición", "cuentas", "año",
+    "niñez", "compañías", "señales", "legitimidad", "evidencia", "empírica", "causas", "efectos",
+    "control", "poder", "judicial", "legislativo", "municipios", "elecciones", "financiamiento",
+    "partidos", "sobornos", "lavado", "activos", "Perú", "Ecuador", "México", "Panamá", "Brasil",
+    "el", "la", "los", "las", "de", "del", "en", "y", "para", "su", "una", "entre", "sobre", "desde"
+};
+
+static const char* conectores[] = {
+    "Un estudio de", "Hacia", "Notas sobre", "El problema de", "Dos estilos de", "La conexión entre"
+};
+
+#define CANTIDAD(arreglo) ((int) (sizeof(arreglo) / sizeof((arreglo)[0])))
+
+// xorshift64*: rapido y con la misma secuencia en cualquier plataforma
+static uint64_t siguiente(uint64_t* estado) {
+    uint64_t x = *estado;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *estado = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static int entero_hasta(uint64_t* estado, int limite) {
+    return (int) (siguiente(estado) % (uint64_t) limite);
+}
+
+static double uniforme(uint64_t* estado) {
+    return (double) (siguiente(estado) >> 11) / (double) (1ULL << 53);
+}
+
+/*año sesgado: con u^3 la densidad se concentra cerca de ANO_MAXIMO, y un 10 % cae en
+unos pocos años "pico" para que haya muchos empates
+*/
+static int generar_ano(uint64_t* estado) {
+    static const int picos[] = {2000, 2010, 2015, 2018, 2020};
+    if (entero_hasta(estado, 10) == 0) {
+        return picos[entero_hasta(estado, CANTIDAD(picos))];
+    }
+    double u = uniforme(estado);
+    return ANO_MAXIMO - (int) (u * u * u * (ANO_MAXIMO - ANO_MINIMO));
+}
+
+static void escribir_palabras(FILE* salida, uint64_t* estado, int cantidad) {
+    for (int p = 0; p < cantidad; p++) {
+        if (p > 0) fputc(' ', salida);
+        fputs(palabras[entero_hasta(estado, CANTIDAD(palabras))], salida);
+    }
+}
+
+//arma el titulo en un buffer porque se escribe dos veces (titulo y ruta)
+static void armar_titulo(char* titulo, size_t capacidad, uint64_t* estado) {
+    size_t usado = 0;
+    titulo[0] = '\0';
+    if (entero_hasta(estado, 4) == 0) {
+        usado += snprintf(titulo, capacidad, "%s ", conectores[entero_hasta(estado, CANTIDAD(conectores))]);
+    }
+    int cantidad = 2 + entero_hasta(estado, 13);
+    for (int p = 0; p < cantidad && usado < capacidad; p++) {
+        usado += snprintf(titulo + usado, capacidad - usado, (p > 0) ? " %s" : "%s",
+                          palabras[entero_hasta(estado, CANTIDAD(palabras))]);
+    }
+}
+
+/*escribe lineas de índice sintético
+E: salida, cantidad de lineas, semilla (0 se cambia por SEMILLA_POR_DEFECTO)
+S: bytes escritos, -1 si hubo error de escritura
+R: que salida este abierta para escribir
+*/
+long generar_indice(FILE* salida, long lineas, uint64_t semilla) {
+    uint64_t estado = (semilla != 0) ? semilla : SEMILLA_POR_DEFECTO;
+    long inicio = ftell(salida);
+    char titulo[512];
+
+    for (long i = 0; i < lineas; i++) {
+        // titulo de 2 a 14 palabras, a veces con un conector al principio
+        armar_titulo(titulo, sizeof(titulo), &estado);
+
+        fprintf(salida, "%s|%s|%s|/repo/%s",
+                nombres[entero_hasta(&estado, CANTIDAD(nombres))],
+                apellidos[entero_hasta(&estado, CANTIDAD(apellidos))],
+                titulo, titulo);
+        if (entero_hasta(&estado, 3) != 0) fputs(".pdf", salida);
+        fprintf(salida, "|%d|", generar_ano(&estado));
+
+        // resumen largo: de 20 a 120 palabras, y uno de cada 50 hasta 600
+        int largo = 20 + entero_hasta(&estado, 101);
+        if (entero_hasta(&estado, 50) == 0) largo = 200 + entero_hasta(&estado, 401);
+        escribir_palabras(salida, &estado, largo);
+        fputs(".|\n", salida);
+
+        if (ferror(salida)) return -1;
+    }
+    return (inicio >= 0) ? ftell(salida) - inicio : 0;
+}
+
+/*crea (o reemplaza) un archivo índice sintético
+E: ruta, cantidad de lineas, semilla
+S: 1 si salio bien, 0 si no
+R: ninguna
+*/
+int generar_archivo(const char* ruta, long lineas, uint64_t semilla) {
+    FILE* salida = fopen(ruta, "w");
+    if (salida == NULL) {
+        perror(ruta);
+        return 0;
+    }
+    static char buffer[1 << 20];
+    setvbuf(salida, buffer, _IOFBF, sizeof(buffer));
+
+    int bien = generar_indice(salida, lineas, semilla) >= 0;
+    if (fclose(salida) != 0) bien = 0;
+    if (!bien) fprintf(stderr, "Error: no se pudo escribir %s\n", ruta);
+    return bien;
+}
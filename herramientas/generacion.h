@@ -0,0 +1,16 @@
+#ifndef GENERACION_H
+#define GENERACION_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Generador de índices sintéticos con el mismo formato que archivoClaseCompleto.txt:
+// nombre|apellido|titulo|ruta|año|resumen|
+// La misma semilla produce siempre el mismo archivo (no depende de rand() de la libc).
+
+#define SEMILLA_POR_DEFECTO 20240601u
+
+long generar_indice(FILE* salida, long lineas, uint64_t semilla); // devuelve los bytes escritos, -1 si falla
+int generar_archivo(const char* ruta, long lineas, uint64_t semilla);
+
+#endif
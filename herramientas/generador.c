@@ -0,0 +1,41 @@
+#include "generacion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*genera un índice sintético para pruebas de rendimiento
+uso: generador LINEAS [--semilla S] [--salida ARCHIVO]   (sin --salida escribe en stdout)
+*/
+int main(int argc, char* argv[]) {
+    long lineas = -1;
+    uint64_t semilla = SEMILLA_POR_DEFECTO;
+    const char* ruta = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            semilla = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--salida") == 0 && i + 1 < argc) {
+            ruta = argv[++i];
+        } else if (lineas < 0 && argv[i][0] != '-') {
+            lineas = atol(argv[i]);
+        } else {
+            lineas = -1;
+            break;
+        }
+    }
+    if (lineas < 0) {
+        fprintf(stderr, "Uso: %s LINEAS [--semilla S] [--salida ARCHIVO]\n", argv[0]);
+        return 1;
+    }
+
+    if (ruta != NULL) {
+        return generar_archivo(ruta, lineas, semilla) ? 0 : 1;
+    }
+    static char buffer[1 << 20];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+    if (generar_indice(stdout, lineas, semilla) < 0 || fflush(stdout) != 0) {
+        fprintf(stderr, "Error: no se pudo escribir la salida\n");
+        return 1;
+    }
+    return 0;
+}
@@ -1,6 +1,9 @@
+#include <errno.h>
+#include <limits.h>  // INT_MAX
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h> 
+#include <unistd.h>
 #include "heap.h" // para struct articulo y los heaps
 
 // limpia el buffer de entrada cuando hay basura
@@ -68,32 +71,526 @@ int mostrar_menu_principal(int totalArticulos, int *cantidadMostrar) {
     return opcion;
 }
 
-/*imprime en pantalla los artículos ordenados de forma clara y legible para el usuario
-E: articulos (arreglo de artículos), n (cantidad de artículos a mostrar), criterio (criterio de ordenamiento)
+/*imprime en pantalla los artículos ordenados con el formato y los campos configurados (por defecto el layout legible de siempre)
+E: articulos (arreglo de artículos), orden (indices de los artículos ya ordenados), n (cantidad de artículos a mostrar), criterio (criterio de ordenamiento)
 S: void
-R: que articulos no sea NULL, que n sea mayor a 0
+R: que articulos y orden no sean NULL, que n sea mayor a 0
 */
-void imprimir_articulos(struct articulo* articulos, int n, const char* criterio) {
-    printf("\n");
-    printf("========================================\n");
-    printf("  RESULTADOS: Ordenados por %s\n", criterio);
-    printf("========================================\n\n");
-
-    for (int i = 0; i < n; i++) {
-        printf("[Artículo %d]\n", i + 1);
-        printf("  Título:   %s\n", articulos[i].titulo_articulo);
-        printf("  Autor:    %s %s\n", articulos[i].nombre_autor, articulos[i].apellido_autor);
-        printf("  Año:      %d\n", articulos[i].ano);
-        printf("  Archivo:  %s\n", articulos[i].ruta);
-        printf("  Resumen:  %s\n", articulos[i].resumen);
-        printf("----------------------------------------\n\n");
-    }
-    printf("Total de artículos mostrados: %d\n", n);
-    printf("----------------------------------------\n");
+void imprimir_articulos(struct articulo* articulos, const uint32_t* orden, int n, const char* criterio) {
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+    fflush(stdout); // lo que ya este en stdio tiene que salir antes que el buffer propio
+    escribir_articulos(STDOUT_FILENO, articulos, orden, n, criterio, formato_salida(), campos_salida());
+    terminar_fase(FASE_IMPRESION, &marca);
 }
 
-int main() {
+/*carga el corpus (de la cache binaria si se puede) anotando el tiempo de la fase de carga
+E: ruta del índice, usar_cache (0 para parsear siempre el texto)
+S: corpus cargado, NULL si falla
+R: ninguna
+*/
+static struct corpus* cargar_indice(const char* indice, int usar_cache) {
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+    struct corpus* corpus = usar_cache ? cargar_corpus_con_cache(indice) : cargar_corpus(indice);
+    terminar_fase(FASE_CARGA, &marca);
+    return corpus;
+}
+
+/*termina el programa: si se pidio --stats escribe la linea de estadisticas antes de salir
+E: codigo de salida
+S: el mismo codigo
+R: ninguna
+*/
+static int terminar(int codigo) {
+    if (estadisticas_activas()) {
+        reportar_estadisticas();
+    }
+    return codigo;
+}
+
+//descripcion de cada criterio para el encabezado de resultados
+static const char* descripcion_criterio[TOTAL_CRITERIOS] = {
+    "titulo (A-Z)", "cantidad de palabras en el titulo", "nombre de archivo", "año"
+};
+
+//una consulta del modo por lotes: criterio (o varios campos), cuantos artículos mostrar (0 = todos) y el filtro
+struct consulta {
+    enum criterio_orden criterio;
+    struct orden_compuesto compuesto; // cantidad 0 = se ordena solo por el criterio
+    const char* descripcion;          // el texto del orden compuesto para el encabezado (copia propia)
+    int limite;
+    struct filtro filtro; // las cadenas son copias propias de la consulta
+};
+
+struct lista_consultas {
+    struct consulta* consultas;
+    int cantidad;
+    int capacidad;
+};
+
+/*libera la lista de consultas con las cadenas de sus filtros
+E: lista
+S: void
+R: ninguna
+*/
+static void liberar_consultas(struct lista_consultas* lista) {
+    for (int q = 0; q < lista->cantidad; q++) {
+        free((char*) lista->consultas[q].filtro.autor);
+        free((char*) lista->consultas[q].filtro.titulo);
+        free((char*) lista->consultas[q].filtro.buscar);
+        free((char*) lista->consultas[q].descripcion);
+    }
+    free(lista->consultas);
+}
+
+/*lee un entero de una opcion: tiene que ser todo el texto (sin letras despues) y estar en el rango
+E: texto, minimo, maximo, valor (donde guardarlo)
+S: 1 si es valido, 0 si no
+R: ninguna
+*/
+static int leer_entero(const char* texto, long minimo, long maximo, long* valor) {
+    char* fin;
+    errno = 0;
+    long leido = strtol(texto, &fin, 10);
+    if (fin == texto || *fin != '\0' || errno != 0 || leido < minimo || leido > maximo) return 0;
+    *valor = leido;
+    return 1;
+}
+
+/*guarda una copia del valor de un filtro de texto (el valor puede venir de un buffer que se reusa)
+E: destino, valor
+S: 1 si salio bien, -1 si no hubo memoria
+R: ninguna
+*/
+static int copiar_filtro(const char** destino, const char* valor) {
+    char* copia = strdup(valor);
+    if (copia == NULL) {
+        fprintf(stderr, "Error: no hay memoria para las consultas.\n");
+        return -1;
+    }
+    free((char*) *destino);
+    *destino = copia;
+    return 1;
+}
+
+/*interpreta una opcion de consulta (--sort CRITERIO o CAMPO[:desc],CAMPO..., --limit N, --anos A-B, --autor PREFIJO,
+--titulo TEXTO o --buscar TERMINOS) y la agrega a la lista; el limite y los filtros se aplican a la ultima consulta agregada
+E: lista, opcion, valor (el argumento que sigue, puede ser NULL)
+S: 1 si la opcion era de consulta y se uso el valor, 0 si no es opcion de consulta, -1 si hay error
+R: que la lista exista
+*/
+static int leer_opcion_consulta(struct lista_consultas* lista, const char* opcion, const char* valor) {
+    int es_orden = (strcmp(opcion, "--sort") == 0 || strcmp(opcion, "--ordenar") == 0);
+    int es_limite = (strcmp(opcion, "--limit") == 0 || strcmp(opcion, "--limite") == 0);
+    int es_anos = (strcmp(opcion, "--anos") == 0 || strcmp(opcion, "--años") == 0 || strcmp(opcion, "--years") == 0);
+    int es_autor = (strcmp(opcion, "--autor") == 0 || strcmp(opcion, "--author") == 0);
+    int es_titulo = (strcmp(opcion, "--titulo") == 0 || strcmp(opcion, "--title") == 0);
+    int es_buscar = (strcmp(opcion, "--buscar") == 0 || strcmp(opcion, "--search") == 0);
+    if (!es_orden && !es_limite && !es_anos && !es_autor && !es_titulo && !es_buscar) return 0;
+
+    if (valor == NULL) {
+        fprintf(stderr, "Error: falta el valor de %s\n", opcion);
+        return -1;
+    }
+
+    if (!es_orden) {
+        if (lista->cantidad == 0) {
+            fprintf(stderr, "Error: %s tiene que ir despues de --sort\n", opcion);
+            return -1;
+        }
+        struct consulta* ultima = &lista->consultas[lista->cantidad - 1];
+        if (es_limite) {
+            long limite;
+            if (!leer_entero(valor, 0, INT_MAX, &limite)) {
+                fprintf(stderr, "Limite invalido: %s (un entero desde 0; 0 = todos)\n", valor);
+                return -1;
+            }
+            ultima->limite = (int) limite;
+        } else if (es_anos) {
+            if (!leer_rango_anos(valor, &ultima->filtro.ano_desde, &ultima->filtro.ano_hasta)) {
+                fprintf(stderr, "Rango de años invalido: %s (por ejemplo 2015-2020)\n", valor);
+                return -1;
+            }
+            ultima->filtro.con_anos = 1;
+        } else if (es_autor) {
+            return copiar_filtro(&ultima->filtro.autor, valor);
+        } else if (es_buscar) {
+            return copiar_filtro(&ultima->filtro.buscar, valor);
+        } else {
+            return copiar_filtro(&ultima->filtro.titulo, valor);
+        }
+        return 1;
+    }
+
+    enum criterio_orden criterio = CRITERIO_TITULO;
+    struct orden_compuesto compuesto = {0};
+    if (!leer_criterio(valor, &criterio) && !leer_orden_compuesto(valor, &compuesto)) {
+        fprintf(stderr, "Criterio desconocido: %s (titulo, palabras, ruta o ano, o campos con direccion"
+                        " como ano:desc,autor,titulo)\n", valor);
+        return -1;
+    }
+    if (lista->cantidad == lista->capacidad) {
+        int nueva = (lista->capacidad > 0) ? lista->capacidad * 2 : 8;
+        struct consulta* consultas = realloc(lista->consultas, nueva * sizeof(struct consulta));
+        if (consultas == NULL) {
+            fprintf(stderr, "Error: no hay memoria para las consultas.\n");
+            return -1;
+        }
+        lista->consultas = consultas;
+        lista->capacidad = nueva;
+    }
+    struct consulta* nueva = &lista->consultas[lista->cantidad];
+    nueva->criterio = criterio;
+    nueva->compuesto = compuesto;
+    nueva->descripcion = NULL;
+    nueva->limite = 0;
+    nueva->filtro = (struct filtro) {0, 0, 0, NULL, NULL, NULL};
+    lista->cantidad++;
+    return (compuesto.cantidad > 0) ? copiar_filtro(&nueva->descripcion, valor) : 1;
+}
+
+//cuantas palabras (opciones y valores) puede tener una consulta en un archivo de consultas
+#define MAXIMO_ARGUMENTOS_CONSULTA 64
+
+/*separa el siguiente argumento de una linea como lo haria la shell: se corta en los espacios salvo
+entre comillas ("..." o '...'), y las comillas se quitan; el argumento queda escrito en la misma linea
+E: cursor (posicion dentro de la linea, avanza), cerrada (se pone en 0 si falta cerrar una comilla)
+S: el argumento, NULL si no quedan
+R: que la linea termine en '\0'
+*/
+static char* siguiente_argumento(char** cursor, int* cerrada) {
+    char* p = *cursor;
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    if (*p == '\0') {
+        *cursor = p;
+        return NULL;
+    }
+
+    char* inicio = p;
+    char* escrito = p;
+    char comilla = 0;
+    while (*p != '\0') {
+        char c = *p++;
+        if (comilla != 0) {
+            if (c == comilla) {
+                comilla = 0;
+            } else {
+                *escrito++ = c;
+            }
+        } else if (c == '"' || c == '\'') {
+            comilla = c;
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            break;
+        } else {
+            *escrito++ = c;
+        }
+    }
+    if (comilla != 0) *cerrada = 0;
+    *escrito = '\0';
+    *cursor = p;
+    return inicio;
+}
+
+/*lee consultas de un archivo (o de stdin con "-"), una por línea con las mismas opciones
+de la linea de comandos, por ejemplo: --sort ano --limit 100 --autor "Vargas Llosa"
+(los valores con espacios van entre comillas, como en la shell)
+las lineas vacias y las que empiezan con # se ignoran
+E: ruta del archivo de consultas, lista
+S: 1 si salio bien, 0 si no
+R: que la lista exista
+*/
+static int leer_archivo_consultas(const char* ruta, struct lista_consultas* lista) {
+    FILE* archivo = (strcmp(ruta, "-") == 0) ? stdin : fopen(ruta, "r");
+    if (archivo == NULL) {
+        fprintf(stderr, "Error: no se pudo abrir el archivo de consultas %s\n", ruta);
+        return 0;
+    }
+
+    char* linea = NULL;
+    size_t capacidad = 0;
+    int bien = 1;
+    int numero_linea = 0;
+    while (bien && getline(&linea, &capacidad, archivo) >= 0) {
+        numero_linea++;
+        char* primero = linea + strspn(linea, " \t\r\n");
+        if (*primero == '\0' || *primero == '#') continue;
+
+        char* tokens[MAXIMO_ARGUMENTOS_CONSULTA];
+        int cantidad = 0;
+        int cerrada = 1;
+        char* cursor = linea;
+        char* token;
+        while (bien && (token = siguiente_argumento(&cursor, &cerrada)) != NULL) {
+            if (cantidad == MAXIMO_ARGUMENTOS_CONSULTA) {
+                fprintf(stderr, "Error: la consulta de la linea %d tiene mas de %d argumentos\n",
+                        numero_linea, MAXIMO_ARGUMENTOS_CONSULTA);
+                bien = 0;
+            } else {
+                tokens[cantidad++] = token;
+            }
+        }
+        if (bien && !cerrada) {
+            fprintf(stderr, "Error: falta cerrar una comilla en la linea %d de %s\n", numero_linea, ruta);
+            bien = 0;
+        }
+
+        for (int t = 0; bien && t < cantidad; t += 2) {
+            int resultado = leer_opcion_consulta(lista, tokens[t], (t + 1 < cantidad) ? tokens[t + 1] : NULL);
+            if (resultado == 0) {
+                fprintf(stderr, "Error: opcion de consulta desconocida: %s\n", tokens[t]);
+            }
+            bien = (resultado == 1);
+        }
+    }
+
+    free(linea);
+    if (archivo != stdin) fclose(archivo);
+    return bien;
+}
+
+/*corre todas las consultas sobre el corpus ya cargado e imprime cada resultado;
+la carga se paga una sola vez para todo el lote
+E: corpus, lista de consultas
+S: 1 si todas salieron bien, 0 si alguna fallo
+R: que el corpus este cargado
+*/
+static int ejecutar_consultas(struct corpus* corpus, const struct lista_consultas* lista) {
+    int bien = 1;
+    for (int q = 0; q < lista->cantidad; q++) {
+        const struct consulta* consulta = &lista->consultas[q];
+        const struct filtro* filtro = &consulta->filtro;
+        const struct orden_compuesto* compuesto = (consulta->compuesto.cantidad > 0) ? &consulta->compuesto : NULL;
+        const char* descripcion = (compuesto != NULL) ? consulta->descripcion : descripcion_criterio[consulta->criterio];
+        if (filtro->con_anos || filtro->autor != NULL || filtro->titulo != NULL || filtro->buscar != NULL) {
+            //consulta filtrada: solo se ordenan los que cumplen
+            int cantidad = 0;
+            uint32_t* filtrados = corpus_filtrar(corpus, filtro, consulta->criterio, compuesto, consulta->limite, &cantidad);
+            if (filtrados == NULL) {
+                fprintf(stderr, "Error: fallo la consulta %d.\n", q + 1);
+                bien = 0;
+                continue;
+            }
+            imprimir_articulos(corpus->articulos, filtrados, cantidad, descripcion);
+            free(filtrados);
+            continue;
+        }
+
+        int cantidad = consulta->limite;
+        if (cantidad <= 0 || cantidad > corpus->total) {
+            cantidad = corpus->total;
+        }
+        if (cantidad == 0) continue;
+
+        if (compuesto != NULL) {
+            //los ordenes compuestos no se guardan en el corpus: se arman las llaves en cada consulta
+            uint32_t* ordenados = ordenar_compuesto_k(corpus, compuesto, NULL, corpus->total, cantidad);
+            if (ordenados == NULL) {
+                fprintf(stderr, "Error: fallo la consulta %d.\n", q + 1);
+                bien = 0;
+                continue;
+            }
+            imprimir_articulos(corpus->articulos, ordenados, cantidad, descripcion);
+            free(ordenados);
+            continue;
+        }
+
+        const uint32_t* ordenados = corpus_obtener_orden(corpus, consulta->criterio, cantidad);
+        if (ordenados == NULL) {
+            fprintf(stderr, "Error: fallo la consulta %d.\n", q + 1);
+            bien = 0;
+            continue;
+        }
+        imprimir_articulos(corpus->articulos, ordenados, cantidad, descripcion);
+    }
+    fflush(stdout);
+    return bien;
+}
+
+/*si alguna consulta busca terminos, deja listo el índice de busqueda antes de correrlas: se mapea
+del archivo .busqueda si esta al dia, si no se arma (y con la cache activa se guarda para la proxima vez)
+E: corpus, ruta del índice, usar_cache, lista de consultas
+S: void (si falla, corpus_buscar lo vuelve a intentar al correr la consulta)
+R: que el corpus este cargado
+*/
+static void preparar_busquedas(struct corpus* corpus, const char* indice, int usar_cache,
+                               const struct lista_consultas* lista) {
+    for (int q = 0; q < lista->cantidad; q++) {
+        if (lista->consultas[q].filtro.buscar != NULL) {
+            struct marca_tiempo marca;
+            iniciar_fase(&marca);
+            preparar_indice_busqueda(corpus, indice, usar_cache);
+            terminar_fase(FASE_CARGA, &marca);
+            return;
+        }
+    }
+}
+
+/*modo vigilar: espera a que se agreguen lineas al índice, las agrega al corpus ya cargado
+(sin volver a ordenar todo, ver corpus_actualizar) y vuelve a correr las consultas; si el archivo
+se reemplazo o se achico se carga completo otra vez (si eso falla se sigue con el corpus que habia).
+sigue hasta que llegue SIGINT o SIGTERM
+E: corpus (puede cambiar si hay que recargar), ruta del índice, usar_cache, lista de consultas
+S: 1 si termino por la señal sin errores, 0 si fallo el vigilante, una recarga o una consulta
+R: que el corpus este cargado
+*/
+static int vigilar_indice(struct corpus** corpus, const char* indice, int usar_cache, const struct lista_consultas* lista) {
+    struct vigilante vigilante;
+    iniciar_vigilante(&vigilante, indice);
+
+    int bien = 1;
+    int estado;
+    while ((estado = esperar_cambio(&vigilante)) > 0) {
+        struct marca_tiempo marca;
+        iniciar_fase(&marca);
+        int agregados = corpus_actualizar(*corpus, indice);
+        struct corpus* nuevo = (agregados < 0) ? cargar_indice(indice, usar_cache) : NULL;
+        terminar_fase(FASE_CARGA, &marca);
+
+        if (nuevo != NULL) {
+            destruir_corpus(*corpus);
+            *corpus = nuevo;
+            preparar_busquedas(nuevo, indice, usar_cache, lista);
+            fprintf(stderr, "Indice recargado: %d articulos.\n", nuevo->total);
+        } else if (agregados < 0) {
+            fprintf(stderr, "Error: no se pudo recargar %s, se sigue con el corpus anterior.\n", indice);
+            bien = 0;
+        } else if (agregados > 0) {
+            fprintf(stderr, "Se agregaron %d articulos (total %d).\n", agregados, (*corpus)->total);
+        }
+        if (nuevo != NULL || agregados > 0) {
+            bien = ejecutar_consultas(*corpus, lista) && bien;
+        }
+    }
+
+    terminar_vigilante(&vigilante);
+    return (estado == 0) && bien;
+}
+
+int main(int argc, char* argv[]) {
     int totalArticulos = 0;
+
+    // opciones de linea de comandos
+    const char* externo[3] = {NULL, NULL, NULL}; // criterio, entrada, salida
+    size_t memoria = 0;
+    int usar_cache = 1;
+    int vigilar = 0;
+    const char* indice = "archivoClaseCompleto.txt";
+    const char* archivo_consultas = NULL;
+    struct lista_consultas lista = {NULL, 0, 0};
+    for (int i = 1; i < argc; i++) {
+        int consulta = leer_opcion_consulta(&lista, argv[i], (i + 1 < argc) ? argv[i + 1] : NULL);
+        if (consulta < 0) {
+            liberar_consultas(&lista);
+            return 1;
+        }
+        if (consulta > 0) {
+            i++; // se uso el valor
+        } else if (strcmp(argv[i], "--entrada") == 0 && i + 1 < argc) {
+            indice = argv[++i];
+        } else if (strcmp(argv[i], "--consultas") == 0 && i + 1 < argc) {
+            archivo_consultas = argv[++i]; // "-" para leerlas de stdin
+        } else if (strcmp(argv[i], "--aridad") == 0 && i + 1 < argc) {
+            long aridad;
+            if (!leer_entero(argv[++i], 2, ARIDAD_HEAP_MAXIMA, &aridad)) {
+                fprintf(stderr, "Aridad invalida: %s (entre 2 y %d)\n", argv[i], ARIDAD_HEAP_MAXIMA);
+                liberar_consultas(&lista);
+                return 1;
+            }
+            configurar_aridad_heaps((int) aridad); // hijos por nodo de los heaps
+        } else if (strcmp(argv[i], "--hilos") == 0 && i + 1 < argc) {
+            long hilos;
+            if (!leer_entero(argv[++i], 1, HILOS_MAXIMOS, &hilos)) {
+                fprintf(stderr, "Cantidad de hilos invalida: %s (entre 1 y %d)\n", argv[i], HILOS_MAXIMOS);
+                liberar_consultas(&lista);
+                return 1;
+            }
+            configurar_hilos_ordenamiento((int) hilos); // hilos para parsear y ordenar
+        } else if (strcmp(argv[i], "--externo") == 0 && i + 3 < argc) {
+            externo[0] = argv[++i];
+            externo[1] = argv[++i];
+            externo[2] = argv[++i];
+        } else if (strcmp(argv[i], "--formato") == 0 && i + 1 < argc) {
+            enum formato_salida formato;
+            if (!leer_formato(argv[++i], &formato)) {
+                fprintf(stderr, "Formato desconocido: %s (humano, tsv, json o rutas)\n", argv[i]);
+                liberar_consultas(&lista);
+                return 1;
+            }
+            configurar_salida(formato, campos_salida());
+        } else if (strcmp(argv[i], "--campos") == 0 && i + 1 < argc) {
+            unsigned campos;
+            if (!leer_campos(argv[++i], &campos)) {
+                fprintf(stderr, "Campos invalidos: %s (titulo,autor,ano,ruta,resumen)\n", argv[i]);
+                liberar_consultas(&lista);
+                return 1;
+            }
+            configurar_salida(formato_salida(), campos);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            configurar_estadisticas(1); // una linea clave=valor en stderr al terminar
+        } else if (strcmp(argv[i], "--vigilar") == 0) {
+            vigilar = 1; // seguir corriendo las consultas cada vez que crezca el índice
+        } else if (strcmp(argv[i], "--sin-cache") == 0) {
+            usar_cache = 0; // siempre parsear el texto
+        } else if (strcmp(argv[i], "--memoria") == 0 && i + 1 < argc) {
+            long megas; // en MB, sin pasarse de lo que entra en un size_t al llevarlo a bytes
+            if (!leer_entero(argv[++i], 1, (long) (SIZE_MAX >> 20), &megas)) {
+                fprintf(stderr, "Memoria invalida: %s (MB, entre 1 y %ld)\n", argv[i], (long) (SIZE_MAX >> 20));
+                liberar_consultas(&lista);
+                return 1;
+            }
+            memoria = (size_t) megas << 20;
+        } else {
+            fprintf(stderr, "Opcion desconocida: %s\n", argv[i]);
+            fprintf(stderr, "Uso: %s [--entrada ARCHIVO] [--hilos N] [--aridad 2-8] [--sin-cache] [--stats] [--formato FORMATO] [--campos LISTA]\n", argv[0]);
+            fprintf(stderr, "     %s --entrada ARCHIVO --sort CRITERIO [--limit N] [--sort ...] [--consultas ARCHIVO|-] [--vigilar]\n", argv[0]);
+            fprintf(stderr, "     (CRITERIO tambien puede ser una lista de campos: ano:desc,autor,titulo)\n");
+            fprintf(stderr, "     (despues de cada --sort: --anos A-B, --autor PREFIJO, --titulo TEXTO,\n");
+            fprintf(stderr, "      --buscar \"TERMINOS [OR TERMINOS]\"; sin mayusculas ni tildes, la ñ es otra letra)\n");
+            fprintf(stderr, "     %s --externo CRITERIO ENTRADA SALIDA [--memoria MB]\n", argv[0]);
+            liberar_consultas(&lista);
+            return 1;
+        }
+    }
+
+    // modo externo: ordena un archivo que no cabe en memoria sin cargarlo completo
+    if (externo[0] != NULL) {
+        enum criterio_orden criterio;
+        if (!leer_criterio(externo[0], &criterio)) {
+            fprintf(stderr, "Criterio desconocido: %s (titulo, palabras, ruta o ano)\n", externo[0]);
+            return 1;
+        }
+        return terminar(ordenar_externo(externo[1], externo[2], criterio, memoria, NULL) ? 0 : 1);
+    }
+
+    if (vigilar && lista.cantidad == 0 && archivo_consultas == NULL) {
+        fprintf(stderr, "Error: --vigilar necesita consultas (--sort o --consultas)\n");
+        return 1;
+    }
+    if (vigilar) {
+        configurar_solo_lineas_completas(1); // una ultima línea sin '\n' se esta escribiendo todavia
+    }
+
+    // modo por lotes: carga una sola vez y corre todas las consultas sin menu
+    if (lista.cantidad > 0 || archivo_consultas != NULL) {
+        configurar_mensajes(0); // stdout queda solo para los resultados
+        int bien = (archivo_consultas == NULL) || leer_archivo_consultas(archivo_consultas, &lista);
+        struct corpus* corpus = NULL;
+        if (bien) {
+            corpus = cargar_indice(indice, usar_cache);
+            bien = (corpus != NULL);
+        }
+        if (bien) {
+            preparar_busquedas(corpus, indice, usar_cache, &lista);
+            bien = ejecutar_consultas(corpus, &lista);
+        }
+        if (corpus != NULL && vigilar) {
+            bien = vigilar_indice(&corpus, indice, usar_cache, &lista) && bien;
+        }
+        destruir_corpus(corpus);
+        liberar_consultas(&lista);
+        return terminar(bien ? 0 : 1);
+    }
     
     printf("===========================================\n");
     printf("  SISTEMA DE ORDENAMIENTO DE ARTICULOS\n");
@@ -102,14 +599,18 @@ int main() {
     
     // acá se carga los artículos del archivo.txt
     printf("Cargando articulos desde archivo.txt...\n");
-    struct articulo* articulos = cargar_articulos("archivoClaseCompleto.txt", &totalArticulos);
+    // si hay una cache binaria al dia se mapea directo, si no se parsea el texto y se guarda la cache
+    struct corpus* corpus = cargar_indice(indice, usar_cache);
     
-    if (articulos == NULL) {
+    if (corpus == NULL) {
         fprintf(stderr, "Error: No se pudieron cargar los articulos.\n");
         fprintf(stderr, "Verifique que el archivo 'archivo.txt' existaaa\n");
         return 1;
     }
     
+    struct articulo* articulos = corpus->articulos;
+    totalArticulos = corpus->total;
+
     printf("\n Articulos cargados exitosamente :) \n");
     printf("Total de articulos disponibles: %d\n", totalArticulos);
     
@@ -119,32 +620,32 @@ int main() {
         int cantidadMostrar = 0;
         int opcion = mostrar_menu_principal(totalArticulos, &cantidadMostrar);
         
-        struct articulo* ordenados = NULL;
+        const uint32_t* ordenados = NULL;
         const char* criterio = NULL;
         
         switch(opcion) {
             case 1: // Ordenar por título
                 printf("\nOrdenando por titulo...\n");
-                ordenados = ordenar_por_titulo(articulos, totalArticulos);
-                criterio = "titulo (A-Z)";
+                ordenados = corpus_obtener_orden(corpus, CRITERIO_TITULO, cantidadMostrar);
+                criterio = descripcion_criterio[CRITERIO_TITULO];
                 break;
                 
             case 2: // Ordenar por cantidad de palabras
                 printf("\nOrdenando por cantidad de palabras en el titulo...\n");
-                ordenados = ordenar_por_palabras_titulo(articulos, totalArticulos);
-                criterio = "cantidad de palabras en el titulo";
+                ordenados = corpus_obtener_orden(corpus, CRITERIO_PALABRAS, cantidadMostrar);
+                criterio = descripcion_criterio[CRITERIO_PALABRAS];
                 break;
                 
             case 3: // Ordenar por nombre de archivo
                 printf("\nOrdenando por nombre de archivo...\n");
-                ordenados = ordenar_por_nombre_archivo(articulos, totalArticulos);
-                criterio = "nombre de archivo";
+                ordenados = corpus_obtener_orden(corpus, CRITERIO_RUTA, cantidadMostrar);
+                criterio = descripcion_criterio[CRITERIO_RUTA];
                 break;
                 
             case 4: // Ordenar por año
                 printf("\nOrdenando por anio...\n");
-                ordenados = ordenar_por_ano(articulos, totalArticulos);
-                criterio = "año";
+                ordenados = corpus_obtener_orden(corpus, CRITERIO_ANO, cantidadMostrar);
+                criterio = descripcion_criterio[CRITERIO_ANO];
                 break;
                 
             case 5: // Salir
@@ -156,20 +657,15 @@ int main() {
         }
         
         // Mostrar resultados si se ordenó correctamente
+        // (la permutacion queda guardada en el corpus para la proxima consulta, no se libera aca)
         if (ordenados != NULL) {
-            imprimir_articulos(ordenados, cantidadMostrar, criterio);
-            
-            // Liberar memoria del array ordenado
-            free(ordenados);
+            imprimir_articulos(articulos, ordenados, cantidadMostrar, criterio);
         }
     }
     
-    // Liberar memoria de los artículos originales
+    // Liberar memoria de los artículos originales (todas las cadenas estan en la arena del corpus)
     printf("\nLiberando memoria...\n");
-    for (int i = 0; i < totalArticulos; i++) { // liberar cada artículo
-        liberar_articulo(&articulos[i]); // función de heap.c
-    }
-    free(articulos);
+    destruir_corpus(corpus);
     
-    return 0;
+    return terminar(0);
 }
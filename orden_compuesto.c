@@ -0,0 +1,215 @@
+#include "heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//la llave compuesta de un artículo junta los campos uno detras de otro, cada uno codificado de forma
+//que comparar las llaves con strcmp de el mismo orden que comparar campo por campo:
+//  - numeros: 5 bytes de 7 bits (sin ceros), invertidos si el campo es descendente
+//  - texto: la llave de colacion y TERMINADOR_ASCENDENTE (menor que cualquier byte de la llave, asi
+//    "ab" queda antes que "abc"); descendente: cada byte b como 0xFF - b y TERMINADOR_DESCENDENTE
+//  - al final el indice del artículo, para que los empates salgan en el orden del índice (estable)
+#define BYTES_NUMERO           5
+#define TERMINADOR_ASCENDENTE  0x01 // las llaves de colacion no usan bytes menores a 0x02
+#define TERMINADOR_DESCENDENTE 0xFE
+#define BYTE_MAXIMO_INVERTIDO  0xFD // los bytes mayores (no aparecen en UTF-8) se invierten como este
+
+/*interpreta una lista de campos con direccion, por ejemplo "ano:desc,autor,titulo"
+(campos: titulo, palabras, ruta, ano y autor, tambien en ingles; direccion asc o desc, por defecto asc)
+E: texto, orden (donde guardar los campos)
+S: 1 si es valida, 0 si no
+R: ninguna
+*/
+int leer_orden_compuesto(const char* texto, struct orden_compuesto* orden) {
+    static const char* nombres[TOTAL_CAMPOS_ORDEN] = {"titulo", "palabras", "ruta", "ano", "autor"};
+    static const char* en_ingles[TOTAL_CAMPOS_ORDEN] = {"title", "words", "path", "year", "author"};
+
+    orden->cantidad = 0;
+    const char* actual = texto;
+    while (1) {
+        const char* fin = actual + strcspn(actual, ",");
+        const char* dos_puntos = memchr(actual, ':', (size_t) (fin - actual));
+        size_t largo_nombre = (size_t) ((dos_puntos != NULL ? dos_puntos : fin) - actual);
+
+        int campo = -1;
+        for (int c = 0; c < TOTAL_CAMPOS_ORDEN && campo < 0; c++) {
+            if ((strlen(nombres[c]) == largo_nombre && strncmp(actual, nombres[c], largo_nombre) == 0) ||
+                (strlen(en_ingles[c]) == largo_nombre && strncmp(actual, en_ingles[c], largo_nombre) == 0)) {
+                campo = c;
+            }
+        }
+        if (campo < 0 && largo_nombre == strlen("año") && strncmp(actual, "año", largo_nombre) == 0) {
+            campo = POR_ANO;
+        }
+
+        int descendente = 0;
+        if (dos_puntos != NULL) {
+            size_t largo_direccion = (size_t) (fin - dos_puntos - 1);
+            if (largo_direccion == 4 && strncmp(dos_puntos + 1, "desc", 4) == 0) {
+                descendente = 1;
+            } else if (!(largo_direccion == 3 && strncmp(dos_puntos + 1, "asc", 3) == 0)) {
+                return 0;
+            }
+        }
+        if (campo < 0 || orden->cantidad == MAXIMO_CAMPOS_ORDEN) return 0;
+
+        orden->campos[orden->cantidad] = (enum campo_orden) campo;
+        orden->descendente[orden->cantidad] = descendente;
+        orden->cantidad++;
+
+        if (*fin == '\0') return 1;
+        actual = fin + 1;
+    }
+}
+
+/*escribe un numero de 32 bits en BYTES_NUMERO bytes de 7 bits (del mas significativo al menos),
+cada uno mas 1 para que ninguno sea 0
+E: destino, valor
+S: void
+R: que el destino tenga BYTES_NUMERO bytes
+*/
+static void escribir_numero(unsigned char* destino, uint32_t valor) {
+    for (int b = 0; b < BYTES_NUMERO; b++) {
+        destino[b] = (unsigned char) (((valor >> (7 * (BYTES_NUMERO - 1 - b))) & 0x7F) + 1);
+    }
+}
+
+//buffer donde se arma cada llave antes de copiarla a la arena
+struct buffer_llave {
+    char* datos;
+    size_t capacidad;
+};
+
+static int asegurar_buffer(struct buffer_llave* buffer, size_t capacidad) {
+    if (capacidad <= buffer->capacidad) return 1;
+    size_t nueva = buffer->capacidad ? buffer->capacidad : 256;
+    while (nueva < capacidad) nueva *= 2;
+    char* datos = realloc(buffer->datos, nueva);
+    if (datos == NULL) return 0;
+    buffer->datos = datos;
+    buffer->capacidad = nueva;
+    return 1;
+}
+
+/*agrega al buffer la llave de colacion de un texto con su terminador segun la direccion
+E: buffer, largo usado, texto, descendente
+S: nuevo largo usado, 0 si no hubo memoria
+R: ninguna
+*/
+static size_t agregar_texto(struct buffer_llave* buffer, size_t usado, const char* texto, int descendente) {
+    size_t largo = escribir_llave_colacion(texto, NULL);
+    if (!asegurar_buffer(buffer, usado + largo + 1)) return 0;
+    unsigned char* destino = (unsigned char*) buffer->datos + usado;
+    escribir_llave_colacion(texto, (char*) destino);
+
+    if (descendente) {
+        for (size_t i = 0; i < largo; i++) {
+            unsigned char b = (destino[i] > BYTE_MAXIMO_INVERTIDO) ? BYTE_MAXIMO_INVERTIDO : destino[i];
+            destino[i] = (unsigned char) (0xFF - b);
+        }
+    }
+    destino[largo] = descendente ? TERMINADOR_DESCENDENTE : TERMINADOR_ASCENDENTE;
+    return usado + largo + 1;
+}
+
+/*llave compuesta de un artículo (ver el comentario del principio)
+E: arena, corpus, orden, indice del artículo, buffer y texto (buffers que se reusan entre llamadas)
+S: llave dentro de la arena, NULL si no hubo memoria
+R: que el orden tenga al menos un campo
+*/
+static char* crear_llave_compuesta(struct arena* arena, const struct corpus* corpus, const struct orden_compuesto* orden,
+                                   uint32_t indice, struct buffer_llave* buffer, struct buffer_llave* texto) {
+    const struct articulo* art = &corpus->articulos[indice];
+    size_t usado = 0;
+
+    for (int c = 0; c < orden->cantidad; c++) {
+        enum campo_orden campo = orden->campos[c];
+        int descendente = orden->descendente[c];
+
+        if (campo == POR_PALABRAS || campo == POR_ANO) {
+            enum criterio_orden criterio = (campo == POR_ANO) ? CRITERIO_ANO : CRITERIO_PALABRAS;
+            const int* columna = corpus->columnas[columna_de_criterio(criterio)];
+            int valor;
+            if (columna != NULL) {
+                valor = columna[indice];
+            } else {
+                llenar_llaves_numericas(art, 1, criterio, &valor);
+            }
+            //el bit de signo invertido deja los negativos antes que los positivos al comparar sin signo
+            uint32_t sin_signo = (uint32_t) valor ^ 0x80000000u;
+            if (!asegurar_buffer(buffer, usado + BYTES_NUMERO)) return NULL;
+            escribir_numero((unsigned char*) buffer->datos + usado, descendente ? ~sin_signo : sin_signo);
+            usado += BYTES_NUMERO;
+            continue;
+        }
+
+        const char* valor;
+        if (campo == POR_AUTOR) {
+            //"apellido nombre", igual que en los filtros de autor
+            const char* apellido = (art->apellido_autor != NULL) ? art->apellido_autor : "";
+            const char* nombre = (art->nombre_autor != NULL) ? art->nombre_autor : "";
+            size_t largo_apellido = strlen(apellido);
+            size_t largo_nombre = strlen(nombre);
+            if (!asegurar_buffer(texto, largo_apellido + largo_nombre + 2)) return NULL;
+            memcpy(texto->datos, apellido, largo_apellido);
+            texto->datos[largo_apellido] = ' ';
+            memcpy(texto->datos + largo_apellido + 1, nombre, largo_nombre + 1);
+            valor = texto->datos;
+        } else {
+            valor = (campo == POR_TITULO) ? art->titulo_articulo : art->ruta;
+        }
+        usado = agregar_texto(buffer, usado, valor, descendente);
+        if (usado == 0) return NULL;
+    }
+
+    if (!asegurar_buffer(buffer, usado + BYTES_NUMERO)) return NULL;
+    escribir_numero((unsigned char*) buffer->datos + usado, indice);
+    usado += BYTES_NUMERO;
+    CONTAR(llaves);
+    return arena_copiar(arena, buffer->datos, usado);
+}
+
+/*ordena artículos por varios campos: arma una llave compuesta por artículo y las ordena con el heap
+alfabético, asi cualquier combinacion de campos se compara con una sola comparacion de bytes;
+como la llave termina en el indice no hay empates y el resultado es estable
+E: corpus, orden, subconjunto (indices a ordenar, NULL = todo el corpus), m (cuantos), k
+S: arreglo nuevo con los k primeros indices del corpus en orden, NULL si falla
+R: que 1 <= k <= m
+*/
+uint32_t* ordenar_compuesto_k(struct corpus* corpus, const struct orden_compuesto* orden, const uint32_t* subconjunto,
+                              int m, int k) {
+    const char** llaves = malloc((size_t) m * sizeof(const char*));
+    if (llaves == NULL) return NULL;
+
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+    struct arena arena;
+    iniciar_arena(&arena, 0);
+    struct buffer_llave buffer = {NULL, 0};
+    struct buffer_llave texto = {NULL, 0};
+    int bien = 1;
+    for (int i = 0; i < m && bien; i++) {
+        uint32_t indice = (subconjunto != NULL) ? subconjunto[i] : (uint32_t) i;
+        llaves[i] = crear_llave_compuesta(&arena, corpus, orden, indice, &buffer, &texto);
+        bien = (llaves[i] != NULL);
+    }
+    free(buffer.datos);
+    free(texto.datos);
+    terminar_fase(FASE_LLAVES, &marca);
+
+    uint32_t* resultado = bien ? ordenar_llaves_alfabeticas_k(llaves, m, k) : NULL;
+    free(llaves);
+    liberar_arena(&arena);
+    if (!bien) {
+        fprintf(stderr, "Error: no hay memoria para las llaves del orden compuesto.\n");
+    }
+    if (resultado == NULL) return NULL;
+
+    //los indices salen relativos al subconjunto
+    if (subconjunto != NULL) {
+        for (int i = 0; i < k; i++) {
+            resultado[i] = subconjunto[resultado[i]];
+        }
+    }
+    return resultado;
+}
@@ -0,0 +1,411 @@
+#include "heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>  // getrlimit
+#include <unistd.h>  // rmdir, unlink
+
+#define DESCRIPTORES_RESERVADOS 16 // entrada, salida, stdio, cache y lo que tenga abierto el resto
+
+//cabeza de una corrida durante la mezcla: la linea actual y su llave
+struct corrida {
+    FILE* archivo;
+    char* linea;
+    size_t capacidad;
+    size_t largo;
+    int llave_numerica;
+    const char* llave_alfabetica;
+    struct arena arena; // llave y campos de la linea actual, se vacia al avanzar
+};
+
+//pedazo del archivo de entrada que cabe en memoria: de cada linea se guarda el texto y la llave,
+//los campos se parsean en una arena aparte que se vacia en cada linea
+struct pedazo {
+    struct arena textos;  // lineas y llaves de colacion
+    struct arena campos;  // campos de la linea que se esta leyendo
+    const char** lineas;
+    size_t* largos;
+    int* llaves_numericas;            // criterios numericos
+    const char** llaves_alfabeticas;  // criterios alfabéticos
+    int cantidad;
+    int capacidad;
+    size_t bytes;         // texto y llaves guardados en la arena
+};
+
+/*quita el salto de línea (y el '\r' de windows) del final de una linea leida con getline
+E: linea, largo leido
+S: largo sin el fin de línea
+R: que la linea no sea NULL
+*/
+static size_t quitar_fin_de_linea(char* linea, size_t largo) {
+    if (largo > 0 && linea[largo - 1] == '\n') largo--;
+    if (largo > 0 && linea[largo - 1] == '\r') largo--;
+    linea[largo] = '\0';
+    return largo;
+}
+
+/*memoria que ocupa el pedazo contando todo lo que se guarda por linea y lo que pide el heap al ordenarlo
+(un nodo y un indice de la permutacion por linea), para compararla contra --memoria
+E: pedazo, criterio
+S: bytes
+R: ninguna
+*/
+static size_t memoria_pedazo(const struct pedazo* pedazo, enum criterio_orden criterio) {
+    int numerico = (criterio == CRITERIO_ANO || criterio == CRITERIO_PALABRAS);
+    size_t por_linea = sizeof(const char*) + sizeof(size_t) + (numerico ? sizeof(int) : sizeof(const char*));
+    size_t por_orden = (numerico ? sizeof(struct nodo_heap_numerico) : sizeof(struct nodo_heap_alfabetico)) +
+                       sizeof(uint32_t);
+    return pedazo->bytes + (size_t) pedazo->capacidad * por_linea + (size_t) pedazo->cantidad * por_orden;
+}
+
+/*agrega una linea al pedazo: copia el texto a la arena y guarda solo su llave (los campos parseados
+se descartan enseguida)
+E: pedazo, linea y su largo (sin salto de línea), criterio
+S: 1 si salio bien, 0 si no
+R: que el pedazo este iniciado
+*/
+static int agregar_linea(struct pedazo* pedazo, const char* linea, size_t largo, enum criterio_orden criterio) {
+    int numerico = (criterio == CRITERIO_ANO || criterio == CRITERIO_PALABRAS);
+    if (pedazo->cantidad == pedazo->capacidad) {
+        int nueva = (pedazo->capacidad > 0) ? pedazo->capacidad * 2 : 1024;
+        const char** lineas = realloc(pedazo->lineas, nueva * sizeof(const char*));
+        if (lineas != NULL) pedazo->lineas = lineas;
+        size_t* largos = realloc(pedazo->largos, nueva * sizeof(size_t));
+        if (largos != NULL) pedazo->largos = largos;
+        int bien = (lineas != NULL && largos != NULL);
+        if (bien && numerico) {
+            int* llaves = realloc(pedazo->llaves_numericas, nueva * sizeof(int));
+            if (llaves != NULL) pedazo->llaves_numericas = llaves;
+            bien = (llaves != NULL);
+        } else if (bien) {
+            const char** llaves = realloc(pedazo->llaves_alfabeticas, nueva * sizeof(const char*));
+            if (llaves != NULL) pedazo->llaves_alfabeticas = llaves;
+            bien = (llaves != NULL);
+        }
+        if (!bien) {
+            fprintf(stderr, "Error: no se pudo agrandar el pedazo en memoria.\n");
+            return 0;
+        }
+        pedazo->capacidad = nueva;
+    }
+
+    const char* copia = arena_copiar(&pedazo->textos, linea, largo);
+    if (copia == NULL) return 0;
+    pedazo->bytes += largo + 1;
+
+    vaciar_arena(&pedazo->campos);
+    struct articulo art = parsear_registro(&pedazo->campos, copia, copia + largo);
+    int i = pedazo->cantidad;
+    if (numerico) {
+        llenar_llaves_numericas(&art, 1, criterio, &pedazo->llaves_numericas[i]);
+    } else {
+        if (!llenar_llaves_alfabeticas(&art, 1, criterio, &pedazo->textos, &pedazo->llaves_alfabeticas[i])) return 0;
+        pedazo->bytes += strlen(pedazo->llaves_alfabeticas[i]) + 1;
+    }
+
+    pedazo->lineas[i] = copia;
+    pedazo->largos[i] = largo;
+    pedazo->cantidad++;
+    return 1;
+}
+
+/*vacia el pedazo para leer el siguiente, reutilizando los arreglos
+E: pedazo
+S: void
+R: ninguna
+*/
+static void vaciar_pedazo(struct pedazo* pedazo) {
+    liberar_arena(&pedazo->textos);
+    iniciar_arena(&pedazo->textos, 0);
+    pedazo->cantidad = 0;
+    pedazo->bytes = 0;
+}
+
+/*ordena el pedazo en memoria con los heaps de siempre (por las llaves ya calculadas) y lo escribe
+como una corrida
+E: pedazo, criterio, ruta del archivo de la corrida
+S: 1 si salio bien, 0 si no
+R: que el pedazo tenga al menos una linea
+*/
+static int escribir_corrida(struct pedazo* pedazo, enum criterio_orden criterio, const char* ruta) {
+    int n = pedazo->cantidad;
+    uint32_t* orden = (criterio == CRITERIO_ANO || criterio == CRITERIO_PALABRAS)
+                      ? ordenar_llaves_numericas_k(pedazo->llaves_numericas, n, n)
+                      : ordenar_llaves_alfabeticas_k(pedazo->llaves_alfabeticas, n, n);
+    if (orden == NULL) return 0;
+
+    FILE* archivo = fopen(ruta, "w");
+    if (archivo == NULL) {
+        fprintf(stderr, "Error: no se pudo crear la corrida %s\n", ruta);
+        free(orden);
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        fwrite(pedazo->lineas[orden[i]], 1, pedazo->largos[orden[i]], archivo);
+        fputc('\n', archivo);
+    }
+
+    int bien = (fclose(archivo) == 0);
+    free(orden);
+    return bien;
+}
+
+/*lee la siguiente linea de una corrida y calcula su llave
+E: corrida, criterio
+S: 1 si se leyo una linea, 0 si la corrida se acabo
+R: que la corrida este abierta
+*/
+static int avanzar_corrida(struct corrida* corrida, enum criterio_orden criterio) {
+    vaciar_arena(&corrida->arena);
+
+    ssize_t leidos;
+    do {
+        leidos = getline(&corrida->linea, &corrida->capacidad, corrida->archivo);
+        if (leidos < 0) return 0;
+        sumar_bytes_leidos((size_t) leidos);
+        corrida->largo = quitar_fin_de_linea(corrida->linea, (size_t) leidos);
+    } while (corrida->largo == 0);
+
+    struct articulo art = parsear_registro(&corrida->arena, corrida->linea, corrida->linea + corrida->largo);
+    if (criterio == CRITERIO_ANO || criterio == CRITERIO_PALABRAS) {
+        llenar_llaves_numericas(&art, 1, criterio, &corrida->llave_numerica);
+    } else {
+        llenar_llaves_alfabeticas(&art, 1, criterio, &corrida->arena, &corrida->llave_alfabetica);
+    }
+    return 1;
+}
+
+/*mezcla todas las corridas (k-way merge) usando el min-heap como cola de prioridad
+y va escribiendo las lineas en la salida
+E: rutas de las corridas, cantidad, criterio, archivo de salida
+S: 1 si salio bien, 0 si no
+R: que cada corrida este ordenada por el criterio
+*/
+static int mezclar_corridas_externas(char** rutas, int cantidad, enum criterio_orden criterio, FILE* salida) {
+    int numerico = (criterio == CRITERIO_ANO || criterio == CRITERIO_PALABRAS);
+    struct corrida* corridas = calloc(cantidad, sizeof(struct corrida));
+    struct heap_numerico* heap_num = numerico ? crear_heap_numerico(cantidad) : NULL;
+    struct heap_alfabetico* heap_alf = numerico ? NULL : crear_heap_alfabetico(cantidad);
+    int bien = (corridas != NULL && (heap_num != NULL || heap_alf != NULL));
+
+    //abrir cada corrida y meter su primera linea al heap
+    for (int r = 0; bien && r < cantidad; r++) {
+        iniciar_arena(&corridas[r].arena, 4096);
+        corridas[r].archivo = fopen(rutas[r], "r");
+        if (corridas[r].archivo == NULL) {
+            fprintf(stderr, "Error: no se pudo abrir la corrida %s\n", rutas[r]);
+            bien = 0;
+        } else if (avanzar_corrida(&corridas[r], criterio)) {
+            if (numerico) {
+                insertar_heap_numerico(heap_num, (uint32_t) r, corridas[r].llave_numerica);
+            } else {
+                insertar_heap_alfabetico(heap_alf, (uint32_t) r, corridas[r].llave_alfabetica);
+            }
+        }
+    }
+
+    //sacar la menor, escribirla y meter la siguiente linea de esa corrida
+    while (bien && !(numerico ? heap_numerico_vacio(heap_num) : heap_alfabetico_vacio(heap_alf))) {
+        uint32_t r = numerico ? extraer_min_heap_numerico(heap_num) : extraer_min_heap_alfabetico(heap_alf);
+        struct corrida* corrida = &corridas[r];
+
+        fwrite(corrida->linea, 1, corrida->largo, salida);
+        fputc('\n', salida);
+
+        if (avanzar_corrida(corrida, criterio)) {
+            if (numerico) {
+                insertar_heap_numerico(heap_num, r, corrida->llave_numerica);
+            } else {
+                insertar_heap_alfabetico(heap_alf, r, corrida->llave_alfabetica);
+            }
+        }
+    }
+
+    for (int r = 0; corridas != NULL && r < cantidad; r++) {
+        if (corridas[r].archivo != NULL) fclose(corridas[r].archivo);
+        free(corridas[r].linea);
+        liberar_arena(&corridas[r].arena);
+    }
+    if (heap_num != NULL) destruir_heap_numerico(heap_num);
+    if (heap_alf != NULL) destruir_heap_alfabetico(heap_alf);
+    free(corridas);
+    return bien;
+}
+
+/*cuantas corridas se pueden mezclar a la vez: MEZCLA_EXTERNO_MAXIMA, o menos si el limite de archivos
+abiertos del proceso (RLIMIT_NOFILE) no alcanza
+E: ninguna
+S: corridas por mezcla, al menos 2
+R: ninguna
+*/
+static int corridas_por_mezcla(void) {
+    int maximo = MEZCLA_EXTERNO_MAXIMA;
+    struct rlimit limite;
+    if (getrlimit(RLIMIT_NOFILE, &limite) == 0 && limite.rlim_cur != RLIM_INFINITY) {
+        rlim_t libres = (limite.rlim_cur > DESCRIPTORES_RESERVADOS) ? limite.rlim_cur - DESCRIPTORES_RESERVADOS : 0;
+        if (libres < (rlim_t) maximo) maximo = (int) libres;
+    }
+    return (maximo < 2) ? 2 : maximo;
+}
+
+/*agrega la ruta de una corrida nueva (carpeta/corrida_N.txt) a la lista
+E: lista de rutas, cantidad, carpeta temporal
+S: la ruta agregada, NULL si no hubo memoria
+R: ninguna
+*/
+static const char* agregar_ruta_corrida(char*** rutas, int* corridas, const char* carpeta) {
+    char** nuevas = realloc(*rutas, (*corridas + 1) * sizeof(char*));
+    if (nuevas == NULL) {
+        fprintf(stderr, "Error: no hay memoria para la lista de corridas.\n");
+        return NULL;
+    }
+    *rutas = nuevas;
+    char ruta[4200];
+    snprintf(ruta, sizeof(ruta), "%s/corrida_%d.txt", carpeta, *corridas);
+    nuevas[*corridas] = malloc(strlen(ruta) + 1);
+    if (nuevas[*corridas] == NULL) {
+        fprintf(stderr, "Error: no hay memoria para la lista de corridas.\n");
+        return NULL;
+    }
+    strcpy(nuevas[*corridas], ruta);
+    return nuevas[(*corridas)++];
+}
+
+/*mezcla las corridas de a grupos consecutivos de "abiertas" en corridas nuevas, pasada tras pasada,
+hasta que quedan a lo sumo "abiertas" para la mezcla final. Los grupos van en orden y la mezcla desempata
+por corrida, asi que las lineas con la misma llave siguen en el orden de la entrada. Las corridas ya
+mezcladas se borran enseguida para no duplicar el espacio en disco
+E: lista de rutas, cantidad (crece con las corridas nuevas), carpeta, criterio, corridas por mezcla,
+   primera corrida que queda por mezclar (salida)
+S: 1 si salio bien, 0 si no
+R: que las corridas existan y esten ordenadas por el criterio
+*/
+static int reducir_corridas(char*** rutas, int* corridas, const char* carpeta, enum criterio_orden criterio,
+                            int abiertas, int* primera) {
+    *primera = 0;
+    while (*corridas - *primera > abiertas) {
+        int fin_pasada = *corridas;
+        for (int r = *primera; r < fin_pasada; r += abiertas) {
+            int grupo = (fin_pasada - r < abiertas) ? fin_pasada - r : abiertas;
+            const char* ruta = agregar_ruta_corrida(rutas, corridas, carpeta);
+            if (ruta == NULL) return 0;
+            FILE* destino = fopen(ruta, "w");
+            if (destino == NULL) {
+                fprintf(stderr, "Error: no se pudo crear la corrida %s\n", ruta);
+                return 0;
+            }
+            int bien = mezclar_corridas_externas(*rutas + r, grupo, criterio, destino);
+            if (fclose(destino) != 0) bien = 0;
+            if (!bien) return 0;
+            for (int g = r; g < r + grupo; g++) unlink((*rutas)[g]);
+            informar("Corridas %d a %d mezcladas en la corrida %d.\n", r + 1, r + grupo, *corridas);
+        }
+        *primera = fin_pasada;
+    }
+    return 1;
+}
+
+/*ordena un archivo índice que puede ser mas grande que la memoria:
+lee pedazos de a lo sumo memoria_maxima bytes (texto, llaves, arreglos y nodos del heap), ordena cada uno y lo guarda como corrida en una carpeta
+temporal, despues mezcla las corridas con el heap (en varias pasadas si son mas de las que se pueden tener
+abiertas) y escribe la salida en el mismo formato de entrada
+E: ruta de entrada, ruta de salida, criterio, memoria_maxima (bytes por pedazo),
+   directorio_temporal (NULL para usar $TMPDIR o /tmp)
+S: 1 si salio bien, 0 si no
+R: que la entrada exista y tenga el formato del índice
+*/
+int ordenar_externo(const char* entrada, const char* salida, enum criterio_orden criterio,
+                    size_t memoria_maxima, const char* directorio_temporal) {
+    if (memoria_maxima == 0) memoria_maxima = MEMORIA_EXTERNO_POR_DEFECTO;
+    if (directorio_temporal == NULL) directorio_temporal = getenv("TMPDIR");
+    if (directorio_temporal == NULL) directorio_temporal = "/tmp";
+
+    FILE* archivo = fopen(entrada, "r");
+    if (archivo == NULL) {
+        printf("Error: no se pudo abrir el archivo %s\n", entrada);
+        return 0;
+    }
+
+    char carpeta[4096];
+    snprintf(carpeta, sizeof(carpeta), "%s/ordenador_XXXXXX", directorio_temporal);
+    if (mkdtemp(carpeta) == NULL) {
+        fprintf(stderr, "Error: no se pudo crear la carpeta temporal en %s\n", directorio_temporal);
+        fclose(archivo);
+        return 0;
+    }
+
+    struct pedazo pedazo;
+    memset(&pedazo, 0, sizeof(pedazo));
+    iniciar_arena(&pedazo.textos, 0);
+    iniciar_arena(&pedazo.campos, 4096);
+
+    char** rutas = NULL;
+    int corridas = 0;
+    int bien = 1;
+    char* linea = NULL;
+    size_t capacidad = 0;
+    ssize_t leidos;
+
+    //fase 1: pedazos ordenados en memoria -> corridas en disco
+    while (bien) {
+        leidos = getline(&linea, &capacidad, archivo);
+        if (leidos >= 0) {
+            sumar_bytes_leidos((size_t) leidos);
+            size_t largo = quitar_fin_de_linea(linea, (size_t) leidos);
+            if (largo > 0) {
+                bien = agregar_linea(&pedazo, linea, largo, criterio);
+            }
+        }
+
+        int lleno = (memoria_pedazo(&pedazo, criterio) >= memoria_maxima);
+        if (bien && pedazo.cantidad > 0 && (lleno || leidos < 0)) {
+            const char* ruta = agregar_ruta_corrida(&rutas, &corridas, carpeta);
+            if (ruta == NULL) {
+                bien = 0;
+                break;
+            }
+
+            bien = escribir_corrida(&pedazo, criterio, ruta);
+            informar("Corrida %d: %d articulos ordenados.\n", corridas, pedazo.cantidad);
+            vaciar_pedazo(&pedazo);
+        }
+        if (leidos < 0) break;
+    }
+    free(linea);
+    fclose(archivo);
+    liberar_arena(&pedazo.textos);
+    liberar_arena(&pedazo.campos);
+    free(pedazo.lineas);
+    free(pedazo.largos);
+    free(pedazo.llaves_numericas);
+    free(pedazo.llaves_alfabeticas);
+
+    //fase 2: mezclar las corridas (de a lo sumo "abiertas" por vez) en la salida
+    int iniciales = corridas;
+    int primera = 0;
+    if (bien) bien = reducir_corridas(&rutas, &corridas, carpeta, criterio, corridas_por_mezcla(), &primera);
+    if (bien) {
+        FILE* destino = fopen(salida, "w");
+        if (destino == NULL) {
+            fprintf(stderr, "Error: no se pudo crear el archivo de salida %s\n", salida);
+            bien = 0;
+        } else {
+            bien = mezclar_corridas_externas(rutas + primera, corridas - primera, criterio, destino);
+            if (fclose(destino) != 0) bien = 0;
+        }
+    }
+
+    //borrar las corridas y la carpeta temporal
+    for (int r = 0; r < corridas; r++) {
+        unlink(rutas[r]);
+        free(rutas[r]);
+    }
+    free(rutas);
+    rmdir(carpeta);
+
+    if (bien) {
+        informar("Archivo ordenado en %s (%d corridas).\n", salida, iniciales);
+    }
+    return bien;
+}
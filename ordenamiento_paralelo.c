@@ -0,0 +1,235 @@
+#include "heap.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//debajo de esta cantidad de artículos por hilo no vale la pena crear hilos
+#define MINIMO_POR_HILO 4096
+
+//cantidad de hilos que usa el ordenamiento paralelo (1 = secuencial)
+static int hilos_configurados = 1;
+
+//trabajo de un hilo: calcula las llaves de su pedazo [inicio, inicio + n), lo ordena y deja ahi los primeros k
+struct trabajo_hilo {
+    struct articulo* articulos;
+    int inicio;
+    int n;
+    int k;
+    enum criterio_orden criterio;
+    int* llaves_numericas;           // arreglo compartido, cada hilo llena solo su pedazo
+    const char** llaves_alfabeticas; // arreglo compartido, cada hilo llena solo su pedazo
+    struct arena arena;              // llaves de colacion del pedazo
+    uint32_t* indices;               // resultado, indices relativos al arreglo completo
+};
+
+/*cambia la cantidad de hilos que usa ordenar_paralelo_top_k
+E: hilos (entre 1 y HILOS_MAXIMOS)
+S: void
+R: si la cantidad no es valida se deja la anterior
+*/
+void configurar_hilos_ordenamiento(int hilos) {
+    if (hilos < 1 || hilos > HILOS_MAXIMOS) {
+        fprintf(stderr, "Advertencia: cantidad de hilos %d invalida, se mantiene %d.\n", hilos, hilos_configurados);
+        return;
+    }
+    hilos_configurados = hilos;
+}
+
+/*devuelve la cantidad de hilos que usa el ordenamiento
+E: ninguna
+S: cantidad de hilos
+R: ninguna
+*/
+int hilos_ordenamiento(void) {
+    return hilos_configurados;
+}
+
+/*funcion que corre cada hilo: saca las llaves de su pedazo y lo ordena con el heap de siempre
+E: puntero a su struct trabajo_hilo
+S: NULL
+R: ninguna
+*/
+static void* ordenar_pedazo(void* arg) {
+    struct trabajo_hilo* trabajo = arg;
+    const struct articulo* pedazo = trabajo->articulos + trabajo->inicio;
+
+    if (trabajo->llaves_numericas != NULL) {
+        int* llaves = trabajo->llaves_numericas + trabajo->inicio;
+        llenar_llaves_numericas(pedazo, trabajo->n, trabajo->criterio, llaves);
+        trabajo->indices = ordenar_llaves_numericas_k(llaves, trabajo->n, trabajo->k);
+    } else {
+        const char** llaves = trabajo->llaves_alfabeticas + trabajo->inicio;
+        if (llenar_llaves_alfabeticas(pedazo, trabajo->n, trabajo->criterio, &trabajo->arena, llaves)) {
+            trabajo->indices = ordenar_llaves_alfabeticas_k(llaves, trabajo->n, trabajo->k);
+        }
+    }
+
+    //los indices salen relativos al pedazo, se pasan a indices del arreglo completo
+    if (trabajo->indices != NULL) {
+        for (int i = 0; i < trabajo->k; i++) {
+            trabajo->indices[i] += (uint32_t) trabajo->inicio;
+        }
+    }
+    acumular_contadores_hilo();
+    return NULL;
+}
+
+/*junta las corridas ordenadas de cada hilo con un k-way merge usando el min-heap:
+en el heap esta la cabeza de cada corrida y el "indice" del nodo es el numero de corrida; como los
+pedazos van en el orden del arreglo, los empates salen por numero de corrida = por indice del artículo
+y el resultado es el mismo que el del ordenamiento en un solo hilo
+E: trabajos ya terminados (con las llaves de todos los artículos), cantidad de corridas, k, arreglo de salida
+S: 1 si salio bien, 0 si no
+R: que cada corrida tenga al menos 1 indice
+*/
+static int mezclar_corridas(struct trabajo_hilo* trabajos, int corridas, int k, uint32_t* salida) {
+    int* posicion = calloc(corridas, sizeof(int));
+    if (posicion == NULL) return 0;
+
+    int* llaves_numericas = trabajos[0].llaves_numericas;
+    const char** llaves_alfabeticas = trabajos[0].llaves_alfabeticas;
+    int numerico = (llaves_numericas != NULL);
+    struct heap_numerico* heap_num = NULL;
+    struct heap_alfabetico* heap_alf = NULL;
+    if (numerico) {
+        heap_num = crear_heap_numerico(corridas);
+    } else {
+        heap_alf = crear_heap_alfabetico(corridas);
+    }
+    if (heap_num == NULL && heap_alf == NULL) {
+        free(posicion);
+        return 0;
+    }
+
+    //meter la cabeza de cada corrida
+    for (int r = 0; r < corridas; r++) {
+        uint32_t cabeza = trabajos[r].indices[0];
+        if (numerico) {
+            insertar_heap_numerico(heap_num, (uint32_t) r, llaves_numericas[cabeza]);
+        } else {
+            insertar_heap_alfabetico(heap_alf, (uint32_t) r, llaves_alfabeticas[cabeza]);
+        }
+    }
+
+    //sacar la menor cabeza, escribirla y meter la siguiente de esa misma corrida
+    for (int i = 0; i < k; i++) {
+        uint32_t r = numerico ? extraer_min_heap_numerico(heap_num) : extraer_min_heap_alfabetico(heap_alf);
+        struct trabajo_hilo* corrida = &trabajos[r];
+
+        salida[i] = corrida->indices[posicion[r]];
+        posicion[r]++;
+
+        if (posicion[r] < corrida->k) {
+            uint32_t siguiente = corrida->indices[posicion[r]];
+            if (numerico) {
+                insertar_heap_numerico(heap_num, r, llaves_numericas[siguiente]);
+            } else {
+                insertar_heap_alfabetico(heap_alf, r, llaves_alfabeticas[siguiente]);
+            }
+        }
+    }
+
+    if (numerico) {
+        destruir_heap_numerico(heap_num);
+    } else {
+        destruir_heap_alfabetico(heap_alf);
+    }
+    free(posicion);
+    return 1;
+}
+
+/*igual que ordenar_top_k pero reparte los artículos en pedazos, ordena cada pedazo en su propio hilo
+y junta los resultados con un k-way merge; con 1 hilo (o pocos artículos) es ordenar_top_k
+E: articulos, n, criterio, k
+S: arreglo de k indices en orden, NULL si falla
+R: que 1 <= k <= n
+*/
+uint32_t* ordenar_paralelo_top_k(struct articulo* articulos, int n, enum criterio_orden criterio, int k) {
+    if (articulos == NULL || n <= 0 || k <= 0 || k > n) {
+        return NULL;
+    }
+
+    int hilos = hilos_configurados;
+    if (hilos > n / MINIMO_POR_HILO) {
+        hilos = n / MINIMO_POR_HILO;
+    }
+    if (hilos <= 1) {
+        return ordenar_top_k(articulos, n, criterio, k);
+    }
+
+    //las llaves de todos los artículos van en un solo arreglo para que la mezcla las pueda leer
+    int numerico = (criterio == CRITERIO_ANO || criterio == CRITERIO_PALABRAS);
+    int* llaves_numericas = numerico ? malloc(n * sizeof(int)) : NULL;
+    const char** llaves_alfabeticas = numerico ? NULL : malloc(n * sizeof(const char*));
+
+    struct trabajo_hilo* trabajos = calloc(hilos, sizeof(struct trabajo_hilo));
+    pthread_t* ids = calloc(hilos, sizeof(pthread_t));
+    uint32_t* salida = calloc(k, sizeof(uint32_t));
+    if (trabajos == NULL || ids == NULL || salida == NULL || (llaves_numericas == NULL && llaves_alfabeticas == NULL)) {
+        fprintf(stderr, "Error: no se pudo asignar memoria para el ordenamiento paralelo.\n");
+        free(llaves_numericas);
+        free(llaves_alfabeticas);
+        free(trabajos);
+        free(ids);
+        free(salida);
+        return NULL;
+    }
+
+    //repartir los artículos en pedazos casi iguales
+    struct marca_tiempo espera;
+    iniciar_fase(&espera);
+    int base = n / hilos;
+    int sobrante = n % hilos;
+    int inicio = 0;
+    for (int h = 0; h < hilos; h++) {
+        trabajos[h].articulos = articulos;
+        trabajos[h].inicio = inicio;
+        trabajos[h].n = base + (h < sobrante ? 1 : 0);
+        trabajos[h].k = (k < trabajos[h].n) ? k : trabajos[h].n; //cada pedazo solo necesita sus primeros k
+        trabajos[h].criterio = criterio;
+        trabajos[h].llaves_numericas = llaves_numericas;
+        trabajos[h].llaves_alfabeticas = llaves_alfabeticas;
+        iniciar_arena(&trabajos[h].arena, 0);
+        inicio += trabajos[h].n;
+
+        if (pthread_create(&ids[h], NULL, ordenar_pedazo, &trabajos[h]) != 0) {
+            ordenar_pedazo(&trabajos[h]); //si no se pudo crear el hilo se ordena aca mismo
+            ids[h] = pthread_self();
+        }
+    }
+
+    for (int h = 0; h < hilos; h++) {
+        if (!pthread_equal(ids[h], pthread_self())) {
+            pthread_join(ids[h], NULL);
+        }
+    }
+    terminar_fase(FASE_ORDEN_HILOS, &espera);
+
+    int bien = 1;
+    for (int h = 0; h < hilos; h++) {
+        if (trabajos[h].indices == NULL) bien = 0;
+    }
+    if (bien) {
+        struct marca_tiempo marca;
+        iniciar_fase(&marca);
+        bien = mezclar_corridas(trabajos, hilos, k, salida);
+        terminar_fase(FASE_EXTRACCION, &marca);
+    }
+
+    for (int h = 0; h < hilos; h++) {
+        free(trabajos[h].indices);
+        liberar_arena(&trabajos[h].arena);
+    }
+    free(llaves_numericas);
+    free(llaves_alfabeticas);
+    free(trabajos);
+    free(ids);
+
+    if (!bien) {
+        fprintf(stderr, "Error: fallo el ordenamiento paralelo.\n");
+        free(salida);
+        return NULL;
+    }
+    return salida;
+}
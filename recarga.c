@@ -0,0 +1,321 @@
+#include "heap.h"
+#include <errno.h>
+#include <fcntl.h>     // open
+#include <poll.h>      // poll
+#include <signal.h>    // sigaction
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // pread, close
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#define VIGILAR_INOTIFY 1
+//cambios del contenido, y que el archivo se mueva o se borre (entonces hay que volver a vigilar la ruta)
+#define EVENTOS_VIGILADOS (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF)
+#endif
+
+//cada cuanto se revisa el archivo aunque no lleguen eventos (o siempre, si no hay inotify)
+#define INTERVALO_SONDEO_MS 1000
+
+//se pone en 1 cuando llega SIGINT o SIGTERM mientras se vigila: el ciclo termina normalmente
+static volatile sig_atomic_t detener_vigilancia = 0;
+static struct sigaction anterior_sigint;
+static struct sigaction anterior_sigterm;
+
+static void pedir_detencion(int senal) {
+    (void) senal;
+    detener_vigilancia = 1;
+}
+
+//lo que hace falta para comparar los artículos viejos contra los del lote nuevo
+struct mezcla {
+    const struct corpus* corpus;
+    enum criterio_orden criterio;
+    const int* columna;  // llaves numericas, NULL si el criterio es alfabético
+    struct arena llaves; // llaves de colacion que se van calculando durante la busqueda
+    int error;
+};
+
+/*compara un artículo viejo contra uno nuevo con el mismo orden que los heaps
+E: mezcla, indice del viejo, indice del nuevo, llave de colacion del nuevo (NULL si es numerico)
+S: <0, 0 o >0 como strcmp
+R: ninguna
+*/
+static int comparar_con_nuevo(struct mezcla* mezcla, uint32_t viejo, uint32_t nuevo, const char* llave_nuevo) {
+    if (mezcla->columna != NULL) {
+        int a = mezcla->columna[viejo];
+        int b = mezcla->columna[nuevo];
+        return (a > b) - (a < b);
+    }
+
+    const struct articulo* art = &mezcla->corpus->articulos[viejo];
+    const char* llave_viejo = crear_llave_colacion(&mezcla->llaves,
+                                                   (mezcla->criterio == CRITERIO_TITULO) ? art->titulo_articulo : art->ruta);
+    if (llave_viejo == NULL) {
+        mezcla->error = 1;
+        return 0;
+    }
+    return strcmp(llave_viejo, llave_nuevo);
+}
+
+/*mezcla un orden ya guardado con el lote de artículos [desde, total) recien agregado:
+el lote se ordena solo, y cada artículo nuevo busca su lugar con busqueda binaria en el orden viejo
+(a partir de donde quedo el anterior), asi se copian n indices y se hacen m log n comparaciones
+en vez de volver a ordenar todo; con un orden parcial (top-k) el prefijo de la mezcla sigue siendo correcto
+E: corpus (con los artículos y columnas ya agregados), criterio, desde (total antes del lote)
+S: 1 si salio bien, 0 si no (el orden guardado se descarta y se recalcula cuando se pida)
+R: que desde < corpus->total
+*/
+static int mezclar_orden(struct corpus* corpus, enum criterio_orden criterio, int desde) {
+    struct orden_guardado* guardado = &corpus->ordenes[criterio];
+    if (guardado->indices == NULL) return 1; //nunca se pidio, no hay nada que mezclar
+
+    int nuevos = corpus->total - desde;
+    int largo = (guardado->largo >= desde) ? corpus->total : guardado->largo;
+    int k_lote = (nuevos < largo) ? nuevos : largo;
+
+    struct marca_tiempo marca;
+    iniciar_fase(&marca);
+
+    uint32_t* lote = corpus_ordenar_rango(corpus, criterio, desde, k_lote);
+    uint32_t* resultado = malloc((size_t) largo * sizeof(uint32_t));
+    if (lote == NULL || resultado == NULL) {
+        free(lote);
+        free(resultado);
+        corpus_invalidar_orden(corpus, criterio);
+        return 0;
+    }
+
+    struct mezcla mezcla;
+    mezcla.corpus = corpus;
+    mezcla.criterio = criterio;
+    int columna = columna_de_criterio(criterio);
+    mezcla.columna = (columna >= 0) ? corpus->columnas[columna] : NULL;
+    iniciar_arena(&mezcla.llaves, 0);
+    mezcla.error = 0;
+
+    const uint32_t* viejos = guardado->indices;
+    int total_viejos = guardado->largo;
+    int salida = 0;
+    int actual = 0; //primer viejo que todavia no se copio
+    for (int j = 0; j < k_lote && salida < largo && !mezcla.error; j++) {
+        const char* llave_nuevo = NULL;
+        if (mezcla.columna == NULL) {
+            const struct articulo* art = &corpus->articulos[lote[j]];
+            llave_nuevo = crear_llave_colacion(&mezcla.llaves,
+                                               (criterio == CRITERIO_TITULO) ? art->titulo_articulo : art->ruta);
+            if (llave_nuevo == NULL) {
+                mezcla.error = 1;
+                break;
+            }
+        }
+
+        //primer viejo que va despues del nuevo; con empate el viejo queda antes
+        int bajo = actual;
+        int alto = total_viejos;
+        while (bajo < alto) {
+            int medio = bajo + (alto - bajo) / 2;
+            if (comparar_con_nuevo(&mezcla, viejos[medio], lote[j], llave_nuevo) <= 0) {
+                bajo = medio + 1;
+            } else {
+                alto = medio;
+            }
+        }
+
+        int copiar = bajo - actual;
+        if (copiar > largo - salida) copiar = largo - salida;
+        memcpy(resultado + salida, viejos + actual, (size_t) copiar * sizeof(uint32_t));
+        salida += copiar;
+        actual = bajo;
+        if (salida < largo) resultado[salida++] = lote[j];
+    }
+    if (!mezcla.error && salida < largo) {
+        int copiar = total_viejos - actual;
+        if (copiar > largo - salida) copiar = largo - salida;
+        memcpy(resultado + salida, viejos + actual, (size_t) copiar * sizeof(uint32_t));
+        salida += copiar;
+    }
+
+    liberar_arena(&mezcla.llaves);
+    free(lote);
+    terminar_fase(FASE_EXTRACCION, &marca);
+
+    if (mezcla.error || salida != largo) {
+        free(resultado);
+        corpus_invalidar_orden(corpus, criterio);
+        return 0;
+    }
+
+    //el orden viejo puede estar en la cache mapeada: ese no se libera, solo se deja de usar
+    if (!guardado->del_mapa) {
+        free(guardado->indices);
+    }
+    guardado->indices = resultado;
+    guardado->largo = largo;
+    guardado->del_mapa = 0;
+    return 1;
+}
+
+/*lee solo lo que se agrego al final del índice desde la ultima carga, lo parsea, lo agrega al corpus
+y mezcla el lote en cada orden guardado; una línea que todavia no termina en '\n' se deja para la
+proxima vez (se asume que el índice solo crece agregando lineas completas al final)
+E: corpus, nombre del índice de texto
+S: cantidad de artículos agregados (0 si no hubo nada nuevo o el archivo no esta), -1 si el archivo
+   se achico, se reemplazo o no se pudo leer y hay que cargarlo completo otra vez
+R: que el corpus se haya cargado de ese mismo archivo
+*/
+int corpus_actualizar(struct corpus* corpus, const char* nombre_archivo) {
+    int fd = open(nombre_archivo, O_RDONLY);
+    if (fd < 0) return 0; //no esta por ahora (lo estan reemplazando): se sigue con lo que hay
+
+    //si es otro archivo (se reemplazo con mv) o se achico, lo cargado ya no es un prefijo
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t) info.st_ino != corpus->inodo_fuente ||
+        (uint64_t) info.st_dev != corpus->dispositivo_fuente ||
+        (size_t) info.st_size < corpus->bytes_fuente) {
+        close(fd);
+        return -1;
+    }
+    size_t disponibles = (size_t) info.st_size - corpus->bytes_fuente;
+    if (disponibles == 0) {
+        close(fd);
+        return 0;
+    }
+    //el ultimo artículo salio de una línea sin '\n' que ahora cambio: no se puede seguir desde aca
+    if (corpus->cola_cargada) {
+        close(fd);
+        return -1;
+    }
+
+    char* texto = malloc(disponibles);
+    if (texto == NULL) {
+        close(fd);
+        return -1;
+    }
+    size_t leidos = 0;
+    while (leidos < disponibles) {
+        ssize_t r = pread(fd, texto + leidos, disponibles - leidos, (off_t) (corpus->bytes_fuente + leidos));
+        if (r <= 0) break;
+        leidos += (size_t) r;
+    }
+    close(fd);
+    sumar_bytes_leidos(leidos);
+
+    //solo lineas completas
+    size_t usados = leidos;
+    while (usados > 0 && texto[usados - 1] != '\n') {
+        usados--;
+    }
+    if (usados == 0) {
+        free(texto);
+        return 0;
+    }
+
+    int desde = corpus->total;
+    int agregados = corpus_agregar_registros(corpus, texto, texto + usados);
+    free(texto);
+    if (agregados < 0) return -1;
+    corpus->bytes_fuente += usados;
+    if (agregados == 0) return 0;
+
+    //los indices de filtro y de busqueda se vuelven a armar con la proxima consulta que los use
+    liberar_indices_filtro(corpus);
+    liberar_indice_busqueda(corpus);
+
+    if (!calcular_columnas_derivadas(corpus, desde)) {
+        corpus_invalidar_ordenes(corpus);
+        return agregados;
+    }
+    for (int c = 0; c < TOTAL_CRITERIOS; c++) {
+        mezclar_orden(corpus, (enum criterio_orden) c, desde);
+    }
+    return agregados;
+}
+
+/*empieza a vigilar un archivo: con inotify si se puede, si no se revisa cada INTERVALO_SONDEO_MS;
+mientras tanto SIGINT y SIGTERM no matan el programa sino que terminan la espera (ver esperar_cambio)
+E: vigilante, ruta del archivo
+S: void
+R: que la ruta siga valida mientras se vigila
+*/
+void iniciar_vigilante(struct vigilante* vigilante, const char* ruta) {
+    vigilante->ruta = ruta;
+    vigilante->fd = -1;
+    vigilante->vigilado = -1;
+
+    //sin SA_RESTART, asi la señal interrumpe el poll y no hay que esperar el intervalo
+    struct sigaction accion;
+    memset(&accion, 0, sizeof(accion));
+    accion.sa_handler = pedir_detencion;
+    sigemptyset(&accion.sa_mask);
+    detener_vigilancia = 0;
+    sigaction(SIGINT, &accion, &anterior_sigint);
+    sigaction(SIGTERM, &accion, &anterior_sigterm);
+#ifdef VIGILAR_INOTIFY
+    vigilante->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (vigilante->fd >= 0) {
+        vigilante->vigilado = inotify_add_watch(vigilante->fd, ruta, EVENTOS_VIGILADOS);
+    }
+#endif
+}
+
+/*espera hasta que el archivo cambie o pase el intervalo de sondeo; quien llama revisa el tamaño
+(si el archivo se reemplazo, por ejemplo con mv, se vuelve a vigilar la ruta)
+E: vigilante
+S: 1 para seguir vigilando, 0 si llego SIGINT o SIGTERM (hay que terminar), -1 si fallo inotify
+R: que se haya llamado iniciar_vigilante
+*/
+int esperar_cambio(struct vigilante* vigilante) {
+    if (detener_vigilancia) return 0;
+    if (vigilante->fd < 0) {
+        poll(NULL, 0, INTERVALO_SONDEO_MS);
+        return detener_vigilancia ? 0 : 1;
+    }
+
+#ifdef VIGILAR_INOTIFY
+    if (vigilante->vigilado < 0) {
+        //el archivo no estaba (se estaba reemplazando): se reintenta en cada intervalo
+        vigilante->vigilado = inotify_add_watch(vigilante->fd, vigilante->ruta, EVENTOS_VIGILADOS);
+    }
+
+    struct pollfd espera = {vigilante->fd, POLLIN, 0};
+    int listos = poll(&espera, 1, INTERVALO_SONDEO_MS);
+    if (detener_vigilancia) return 0;
+    if (listos < 0 && errno != EINTR) {
+        fprintf(stderr, "Error: no se pudo esperar cambios en %s\n", vigilante->ruta);
+        return -1;
+    }
+    if (listos <= 0) return 1;
+
+    //vaciar los eventos; si el archivo se fue hay que volver a vigilar la ruta
+    char eventos[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int reemplazado = 0;
+    ssize_t leidos;
+    while ((leidos = read(vigilante->fd, eventos, sizeof(eventos))) > 0) {
+        for (char* p = eventos; p < eventos + leidos; ) {
+            const struct inotify_event* evento = (const struct inotify_event*) p;
+            if (evento->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) reemplazado = 1;
+            p += sizeof(struct inotify_event) + evento->len;
+        }
+    }
+    if (leidos < 0 && errno != EAGAIN && errno != EINTR) {
+        fprintf(stderr, "Error: no se pudieron leer los eventos de %s\n", vigilante->ruta);
+        return -1;
+    }
+    if (reemplazado) {
+        if (vigilante->vigilado >= 0) inotify_rm_watch(vigilante->fd, vigilante->vigilado);
+        vigilante->vigilado = inotify_add_watch(vigilante->fd, vigilante->ruta, EVENTOS_VIGILADOS);
+    }
+#endif
+    return 1;
+}
+
+void terminar_vigilante(struct vigilante* vigilante) {
+    if (vigilante->fd >= 0) close(vigilante->fd);
+    vigilante->fd = -1;
+    vigilante->vigilado = -1;
+    sigaction(SIGINT, &anterior_sigint, NULL);
+    sigaction(SIGTERM, &anterior_sigterm, NULL);
+}
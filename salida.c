@@ -0,0 +1,388 @@
+#include "heap.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+//los pedazos mas grandes que esto no se copian al buffer, se mandan directo con writev
+#define PEDAZO_DIRECTO (TAMANO_BUFFER_SALIDA / 4)
+
+//formato y campos que usa imprimir_articulos (se cambian con configurar_salida)
+static enum formato_salida formato_configurado = FORMATO_HUMANO;
+static unsigned campos_configurados = CAMPOS_TODOS;
+
+//nombres de los campos en el mismo orden que los bits CAMPO_*
+static const char* nombres_campos[] = {"titulo", "autor", "ano", "ruta", "resumen"};
+#define TOTAL_CAMPOS ((int) (sizeof(nombres_campos) / sizeof(nombres_campos[0])))
+
+/*escribe todos los pedazos de iov en fd, reintentando las escrituras parciales
+E: fd, iov (se modifica), cantidad de pedazos
+S: 1 si se escribio todo, 0 si hubo error
+R: ninguna
+*/
+static int escribir_todo(int fd, struct iovec* iov, int cantidad) {
+    while (cantidad > 0) {
+        ssize_t escritos = writev(fd, iov, cantidad);
+        if (escritos < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        while (cantidad > 0 && (size_t) escritos >= iov->iov_len) {
+            escritos -= (ssize_t) iov->iov_len;
+            iov++;
+            cantidad--;
+        }
+        if (cantidad > 0) {
+            iov->iov_base = (char*) iov->iov_base + escritos;
+            iov->iov_len -= (size_t) escritos;
+        }
+    }
+    return 1;
+}
+
+/*prepara un escritor sobre un descriptor de archivo
+E: escritor, fd
+S: void
+R: que el escritor exista
+*/
+void iniciar_escritor(struct escritor* escritor, int fd) {
+    escritor->fd = fd;
+    escritor->usado = 0;
+    escritor->error = 0;
+}
+
+/*manda al descriptor lo que haya en el buffer
+E: escritor
+S: 1 si salio bien, 0 si alguna escritura fallo
+R: que el escritor este iniciado
+*/
+int vaciar_escritor(struct escritor* escritor) {
+    if (escritor->usado > 0 && !escritor->error) {
+        struct iovec iov = {escritor->buffer, escritor->usado};
+        escritor->error = !escribir_todo(escritor->fd, &iov, 1);
+    }
+    escritor->usado = 0;
+    return !escritor->error;
+}
+
+/*agrega bytes al buffer; si es un pedazo grande (un resumen largo, por ejemplo) se manda
+junto con lo que ya habia en una sola llamada a writev, sin copiarlo
+E: escritor, datos, largo
+S: void
+R: que el escritor este iniciado
+*/
+void escritor_agregar(struct escritor* escritor, const char* datos, size_t largo) {
+    if (largo <= TAMANO_BUFFER_SALIDA - escritor->usado) {
+        memcpy(escritor->buffer + escritor->usado, datos, largo);
+        escritor->usado += largo;
+        return;
+    }
+    if (largo < PEDAZO_DIRECTO) {
+        vaciar_escritor(escritor);
+        memcpy(escritor->buffer, datos, largo);
+        escritor->usado = largo;
+        return;
+    }
+    if (!escritor->error) {
+        struct iovec iov[2] = {{escritor->buffer, escritor->usado}, {(void*) datos, largo}};
+        escritor->error = !escribir_todo(escritor->fd, iov, 2);
+    }
+    escritor->usado = 0;
+}
+
+//los campos que faltan en el registro quedan en NULL y se escriben vacios
+static void agregar_texto(struct escritor* escritor, const char* texto) {
+    if (texto == NULL) return;
+    escritor_agregar(escritor, texto, strlen(texto));
+}
+
+static void agregar_caracter(struct escritor* escritor, char c) {
+    if (escritor->usado == TAMANO_BUFFER_SALIDA) {
+        vaciar_escritor(escritor);
+    }
+    escritor->buffer[escritor->usado++] = c;
+}
+
+/*agrega un entero en decimal sin pasar por printf
+E: escritor, valor
+S: void
+R: ninguna
+*/
+static void agregar_entero(struct escritor* escritor, int valor) {
+    char digitos[12];
+    int pos = sizeof(digitos);
+    unsigned magnitud = (valor < 0) ? 0u - (unsigned) valor : (unsigned) valor;
+    do {
+        digitos[--pos] = (char) ('0' + magnitud % 10);
+        magnitud /= 10;
+    } while (magnitud > 0);
+    if (valor < 0) digitos[--pos] = '-';
+    escritor_agregar(escritor, digitos + pos, sizeof(digitos) - pos);
+}
+
+/*agrega un campo para TSV: tabuladores, saltos de linea y \ se escapan para no romper las columnas
+E: escritor, texto
+S: void
+R: ninguna
+*/
+static void agregar_tsv(struct escritor* escritor, const char* texto) {
+    const char* p = (texto != NULL) ? texto : "";
+    for (;;) {
+        size_t limpio = strcspn(p, "\t\n\r\\"); // strcspn de la libc recorre varios bytes a la vez
+        escritor_agregar(escritor, p, limpio);
+        p += limpio;
+        if (*p == '\0') return;
+
+        char escape = (*p == '\t') ? 't' : (*p == '\n') ? 'n' : (*p == '\r') ? 'r' : '\\';
+        agregar_caracter(escritor, '\\');
+        agregar_caracter(escritor, escape);
+        p++;
+    }
+}
+
+/*agrega una cadena JSON entre comillas; los bytes UTF-8 pasan tal cual
+E: escritor, texto
+S: void
+R: ninguna
+*/
+static void agregar_json(struct escritor* escritor, const char* texto) {
+    //comillas, \ y los bytes de control (el \0 del final lo pone la cadena)
+    static const char especiales[] =
+        "\"\\\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"
+        "\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f";
+    static const char hexadecimal[] = "0123456789abcdef";
+
+    agregar_caracter(escritor, '"');
+    const char* p = (texto != NULL) ? texto : "";
+    for (;;) {
+        size_t limpio = strcspn(p, especiales);
+        escritor_agregar(escritor, p, limpio);
+        p += limpio;
+        if (*p == '\0') break;
+
+        unsigned char c = (unsigned char) *p++;
+        agregar_caracter(escritor, '\\');
+        switch (c) {
+            case '"': agregar_caracter(escritor, '"'); break;
+            case '\\': agregar_caracter(escritor, '\\'); break;
+            case '\n': agregar_caracter(escritor, 'n'); break;
+            case '\r': agregar_caracter(escritor, 'r'); break;
+            case '\t': agregar_caracter(escritor, 't'); break;
+            default:
+                agregar_texto(escritor, "u00");
+                agregar_caracter(escritor, hexadecimal[c >> 4]);
+                agregar_caracter(escritor, hexadecimal[c & 0xF]);
+        }
+    }
+    agregar_caracter(escritor, '"');
+}
+
+//layout de siempre del menu, mostrando solo los campos pedidos
+static void escribir_humano(struct escritor* escritor, const struct articulo* art, int posicion, unsigned campos) {
+    agregar_texto(escritor, "[Artículo ");
+    agregar_entero(escritor, posicion);
+    agregar_texto(escritor, "]\n");
+    if (campos & CAMPO_TITULO) {
+        agregar_texto(escritor, "  Título:   ");
+        agregar_texto(escritor, art->titulo_articulo);
+        agregar_caracter(escritor, '\n');
+    }
+    if (campos & CAMPO_AUTOR) {
+        agregar_texto(escritor, "  Autor:    ");
+        agregar_texto(escritor, art->nombre_autor);
+        agregar_caracter(escritor, ' ');
+        agregar_texto(escritor, art->apellido_autor);
+        agregar_caracter(escritor, '\n');
+    }
+    if (campos & CAMPO_ANO) {
+        agregar_texto(escritor, "  Año:      ");
+        agregar_entero(escritor, art->ano);
+        agregar_caracter(escritor, '\n');
+    }
+    if (campos & CAMPO_RUTA) {
+        agregar_texto(escritor, "  Archivo:  ");
+        agregar_texto(escritor, art->ruta);
+        agregar_caracter(escritor, '\n');
+    }
+    if (campos & CAMPO_RESUMEN) {
+        agregar_texto(escritor, "  Resumen:  ");
+        agregar_texto(escritor, art->resumen);
+        agregar_caracter(escritor, '\n');
+    }
+    agregar_texto(escritor, "----------------------------------------\n\n");
+}
+
+//una linea por artículo, columnas en el orden fijo de los campos (el autor ocupa dos: nombre y apellido)
+static void escribir_tsv(struct escritor* escritor, const struct articulo* art, unsigned campos) {
+    int primero = 1;
+    for (int c = 0; c < TOTAL_CAMPOS; c++) {
+        unsigned campo = 1u << c;
+        if (!(campos & campo)) continue;
+        if (!primero) agregar_caracter(escritor, '\t');
+        primero = 0;
+
+        switch (campo) {
+            case CAMPO_TITULO: agregar_tsv(escritor, art->titulo_articulo); break;
+            case CAMPO_AUTOR:
+                agregar_tsv(escritor, art->nombre_autor);
+                agregar_caracter(escritor, '\t');
+                agregar_tsv(escritor, art->apellido_autor);
+                break;
+            case CAMPO_ANO: agregar_entero(escritor, art->ano); break;
+            case CAMPO_RUTA: agregar_tsv(escritor, art->ruta); break;
+            case CAMPO_RESUMEN: agregar_tsv(escritor, art->resumen); break;
+        }
+    }
+    agregar_caracter(escritor, '\n');
+}
+
+//un objeto JSON por linea
+static void escribir_json(struct escritor* escritor, const struct articulo* art, unsigned campos) {
+    const char* separador = "{";
+    if (campos & CAMPO_TITULO) {
+        agregar_texto(escritor, separador);
+        agregar_texto(escritor, "\"titulo\":");
+        agregar_json(escritor, art->titulo_articulo);
+        separador = ",";
+    }
+    if (campos & CAMPO_AUTOR) {
+        agregar_texto(escritor, separador);
+        agregar_texto(escritor, "\"nombre_autor\":");
+        agregar_json(escritor, art->nombre_autor);
+        agregar_texto(escritor, ",\"apellido_autor\":");
+        agregar_json(escritor, art->apellido_autor);
+        separador = ",";
+    }
+    if (campos & CAMPO_ANO) {
+        agregar_texto(escritor, separador);
+        agregar_texto(escritor, "\"ano\":");
+        agregar_entero(escritor, art->ano);
+        separador = ",";
+    }
+    if (campos & CAMPO_RUTA) {
+        agregar_texto(escritor, separador);
+        agregar_texto(escritor, "\"ruta\":");
+        agregar_json(escritor, art->ruta);
+        separador = ",";
+    }
+    if (campos & CAMPO_RESUMEN) {
+        agregar_texto(escritor, separador);
+        agregar_texto(escritor, "\"resumen\":");
+        agregar_json(escritor, art->resumen);
+        separador = ",";
+    }
+    if (separador[0] == '{') agregar_caracter(escritor, '{');
+    agregar_texto(escritor, "}\n");
+}
+
+/*escribe n artículos en el orden dado con el formato y los campos indicados
+E: fd, articulos, orden (indices a articulos), n, criterio (para el encabezado del formato humano),
+   formato, campos (bits CAMPO_*)
+S: 1 si se escribio todo, 0 si alguna escritura fallo
+R: que orden tenga al menos n indices validos
+*/
+int escribir_articulos(int fd, const struct articulo* articulos, const uint32_t* orden, int n,
+                       const char* criterio, enum formato_salida formato, unsigned campos) {
+    struct escritor* escritor = malloc(sizeof(struct escritor));
+    if (escritor == NULL) {
+        fprintf(stderr, "Error: no hay memoria para el buffer de salida.\n");
+        return 0;
+    }
+    iniciar_escritor(escritor, fd);
+
+    if (formato == FORMATO_HUMANO) {
+        agregar_texto(escritor, "\n========================================\n  RESULTADOS: Ordenados por ");
+        agregar_texto(escritor, criterio);
+        agregar_texto(escritor, "\n========================================\n\n");
+    }
+
+    for (int i = 0; i < n; i++) {
+        const struct articulo* art = &articulos[orden[i]];
+        switch (formato) {
+            case FORMATO_HUMANO: escribir_humano(escritor, art, i + 1, campos); break;
+            case FORMATO_TSV: escribir_tsv(escritor, art, campos); break;
+            case FORMATO_JSON: escribir_json(escritor, art, campos); break;
+            case FORMATO_RUTAS:
+                agregar_texto(escritor, art->ruta);
+                agregar_caracter(escritor, '\n');
+                break;
+        }
+    }
+
+    if (formato == FORMATO_HUMANO) {
+        agregar_texto(escritor, "Total de artículos mostrados: ");
+        agregar_entero(escritor, n);
+        agregar_texto(escritor, "\n----------------------------------------\n");
+    }
+
+    int bien = vaciar_escritor(escritor);
+    free(escritor);
+    if (!bien) {
+        perror("Error al escribir los resultados");
+    }
+    return bien;
+}
+
+/*cambia el formato y los campos que usa imprimir_articulos
+E: formato, campos (bits CAMPO_*)
+S: void
+R: ninguna
+*/
+void configurar_salida(enum formato_salida formato, unsigned campos) {
+    formato_configurado = formato;
+    campos_configurados = campos;
+}
+
+enum formato_salida formato_salida(void) {
+    return formato_configurado;
+}
+
+unsigned campos_salida(void) {
+    return campos_configurados;
+}
+
+/*convierte el nombre de un formato al enum
+E: nombre ("humano", "tsv", "json" o "rutas", o en ingles "human", "jsonl", "paths"), formato
+S: 1 si el nombre es valido, 0 si no
+R: que los punteros no sean NULL
+*/
+int leer_formato(const char* nombre, enum formato_salida* formato) {
+    static const char* nombres[] = {"humano", "tsv", "json", "rutas"};
+    static const char* en_ingles[] = {"human", "tsv", "jsonl", "paths"};
+
+    for (int f = 0; f < (int) (sizeof(nombres) / sizeof(nombres[0])); f++) {
+        if (strcmp(nombre, nombres[f]) == 0 || strcmp(nombre, en_ingles[f]) == 0) {
+            *formato = (enum formato_salida) f;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*convierte una lista de campos separados por comas ("titulo,ano,ruta") a bits CAMPO_*
+E: lista, campos (donde guardar el resultado)
+S: 1 si todos los nombres son validos, 0 si no
+R: que los punteros no sean NULL
+*/
+int leer_campos(const char* lista, unsigned* campos) {
+    unsigned resultado = 0;
+    const char* p = lista;
+    while (*p) {
+        size_t largo = strcspn(p, ",");
+        int encontrado = 0;
+        for (int c = 0; c < TOTAL_CAMPOS; c++) {
+            if (strlen(nombres_campos[c]) == largo && strncmp(p, nombres_campos[c], largo) == 0) {
+                resultado |= 1u << c;
+                encontrado = 1;
+            }
+        }
+        if (!encontrado && largo > 0) return 0;
+        p += largo;
+        if (*p == ',') p++;
+    }
+    if (resultado == 0) return 0;
+    *campos = resultado;
+    return 1;
+}